@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The Clock class.
+ * Single source of time for the statistics system. It follows the system
+ * clocks unless virtual time is enabled, which lets a simulation replay hours
+ * of usage in seconds and deterministically.
+ *
+ * @~german
+ * @brief Die Klasse Clock.
+ * Einzige Zeitquelle des Statistiksystems. Sie folgt den Systemuhren, außer
+ * virtuelle Zeit ist aktiviert; damit kann eine Simulation Stunden an
+ * Nutzung in Sekunden und deterministisch abspielen.
+ */
+@interface Clock : NSObject {}
+
+/**
+ * @~english
+ * @brief Current wall clock time.
+ * @return Seconds since 1970.
+ *
+ * @~german
+ * @brief Aktuelle Uhrzeit.
+ * @return Sekunden seit 1970.
+ */
++ (NSTimeInterval)now;
+
+/**
+ * @~english
+ * @brief Monotonic high-resolution time.
+ * @return Nanoseconds since an arbitrary point in time.
+ *
+ * @~german
+ * @brief Monotone hochauflösende Zeit.
+ * @return Nanosekunden seit einem beliebigen Zeitpunkt.
+ */
++ (uint64_t)uptime;
+
+/**
+ * @~english
+ * @brief Switches to virtual time, which only moves with Clock#advanceTo:.
+ * @param start   The virtual wall clock time in seconds since 1970.
+ *
+ * @~german
+ * @brief Wechselt zu virtueller Zeit, die sich nur mit Clock#advanceTo:
+ * bewegt.
+ * @param start   Die virtuelle Uhrzeit in Sekunden seit 1970.
+ */
++ (void)useVirtualTime:(NSTimeInterval)start;
+
+/**
+ * @~english
+ * @brief Moves virtual time forward. Earlier times are ignored.
+ * @param time   The new virtual wall clock time in seconds since 1970.
+ *
+ * @~german
+ * @brief Bewegt die virtuelle Zeit vorwärts. Frühere Zeiten werden ignoriert.
+ * @param time   Die neue virtuelle Uhrzeit in Sekunden seit 1970.
+ */
++ (void)advanceTo:(NSTimeInterval)time;
+
+@end
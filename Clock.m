@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* sys header */
+#include <mach/mach_time.h>
+
+/* local header */
+#import "Clock.h"
+
+static BOOL m_virtual = NO;
+static NSTimeInterval m_virtualStart = 0;
+static NSTimeInterval m_virtualNow = 0;
+
+@implementation Clock
+
++ (NSTimeInterval)now {
+
+  if ( m_virtual ) {
+
+    return m_virtualNow;
+  }
+  return [[NSDate date] timeIntervalSince1970];
+}
+
++ (uint64_t)uptime {
+
+  if ( m_virtual ) {
+
+    return ( uint64_t )( ( m_virtualNow - m_virtualStart ) * NSEC_PER_SEC );
+  }
+
+  static mach_timebase_info_data_t timebase;
+  if ( timebase.denom == 0 ) {
+
+    mach_timebase_info(&timebase);
+  }
+  uint64_t ticks = mach_absolute_time();
+  if ( timebase.numer == timebase.denom ) {
+
+    return ticks;
+  }
+  return ticks * timebase.numer / timebase.denom;
+}
+
++ (void)useVirtualTime:(NSTimeInterval)start {
+
+  m_virtualStart = start;
+  m_virtualNow = start;
+  m_virtual = YES;
+}
+
++ (void)advanceTo:(NSTimeInterval)time {
+
+  if ( time > m_virtualNow ) {
+
+    m_virtualNow = time;
+  }
+}
+
+@end
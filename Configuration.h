@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The Configuration class.
+ * Immutable snapshot of the settings delivered by the statistics server. A new
+ * snapshot replaces the previous one as a whole, so readers never see a
+ * partially applied configuration.
+ *
+ * @b Example:
+ * @code
+ * {
+ *   "batchSize": 50,
+ *   "flushCount": 1024,
+ *   "flushInterval": 300,
+ *   "sampling": 0.25,
+ *   "disabledActions": [ "shake", "span" ],
+ *   "compression": true,
+ *   "serverFilePaths": [ "https://eu.vxstats.com", "https://us.vxstats.com" ],
+ *   "maxAge": 21600
+ * }
+ * @endcode
+ *
+ * @~german
+ * @brief Die Klasse Configuration.
+ * Unveränderlicher Stand der Einstellungen, die der Statistikserver liefert.
+ * Ein neuer Stand ersetzt den vorherigen vollständig, Leser sehen daher nie
+ * eine teilweise übernommene Konfiguration.
+ */
+@interface Configuration : NSObject
+
+/**
+ * @~english
+ * @brief Maximum number of offline messages sent per reconnect, 0 for all.
+ *
+ * @~german
+ * @brief Maximale Anzahl an Offline-Nachrichten pro Verbindungsaufbau, 0 für
+ * alle.
+ */
+@property (nonatomic, readonly) NSUInteger batchSize;
+
+/**
+ * @~english
+ * @brief Number of span samples per name that triggers a summary.
+ *
+ * @~german
+ * @brief Anzahl an Span-Messungen pro Name, die eine Zusammenfassung auslöst.
+ */
+@property (nonatomic, readonly) uint32_t flushCount;
+
+/**
+ * @~english
+ * @brief Maximum age in seconds of span histograms.
+ *
+ * @~german
+ * @brief Maximales Alter der Span-Histogramme in Sekunden.
+ */
+@property (nonatomic, readonly) NSTimeInterval flushInterval;
+
+/**
+ * @~english
+ * @brief Share of events that is transferred, between 0 and 1.
+ *
+ * @~german
+ * @brief Anteil der übertragenen Events, zwischen 0 und 1.
+ */
+@property (nonatomic, readonly) double sampling;
+
+/**
+ * @~english
+ * @brief Actions that are not transferred, 'page' for page impressions.
+ *
+ * @~german
+ * @brief Aktionen, die nicht übertragen werden, 'page' für Seitenimpressionen.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *disabledActions;
+
+/**
+ * @~english
+ * @brief True, if messages are sent deflate compressed.
+ *
+ * @~german
+ * @brief Wahr, wenn Nachrichten deflate-komprimiert gesendet werden.
+ */
+@property (nonatomic, readonly) BOOL compression;
+
+/**
+ * @~english
+ * @brief Paths to statistics servers overriding the local ones, or nil. A
+ * single 'serverFilePath' is accepted as well.
+ *
+ * @~german
+ * @brief Pfade zu Statistikservern, die die lokalen ersetzen, oder nil. Ein
+ * einzelner 'serverFilePath' wird ebenfalls akzeptiert.
+ */
+@property (nonatomic, readonly) NSArray<NSString *> *serverFilePaths;
+
+/**
+ * @~english
+ * @brief Seconds until the configuration is revalidated.
+ *
+ * @~german
+ * @brief Sekunden, bis die Konfiguration erneut geprüft wird.
+ */
+@property (nonatomic, readonly) NSTimeInterval maxAge;
+
+/**
+ * @~english
+ * @brief Creates a configuration from the decoded server document. Missing or
+ * invalid values use the defaults.
+ * @param dictionary   The decoded JSON document.
+ * @return The configuration.
+ *
+ * @~german
+ * @brief Erstellt eine Konfiguration aus dem dekodierten Serverdokument.
+ * Fehlende oder ungültige Werte verwenden die Standardwerte.
+ * @param dictionary   Das dekodierte JSON-Dokument.
+ * @return Die Konfiguration.
+ */
+- (id)initWithDictionary:(NSDictionary *)dictionary;
+
+/**
+ * @~english
+ * @brief Returns true, if an event with the escaped action should be sent.
+ * Applies the disabled actions and the sampling rate.
+ * @param action   The escaped action, nil for page impressions.
+ * @return True, if the event should be sent - otherwise false.
+ *
+ * @~german
+ * @brief Gibt wahr zurück, wenn ein Event mit der maskierten Aktion gesendet
+ * werden soll. Berücksichtigt deaktivierte Aktionen und die Stichprobenrate.
+ * @param action   Die maskierte Aktion, nil für Seitenimpressionen.
+ * @return Wahr, wenn das Event gesendet werden soll - sonst falsch.
+ */
+- (BOOL)allowsAction:(NSString *)action;
+
+/**
+ * @~english
+ * @brief The configuration used until the server delivered one.
+ * @return The default configuration.
+ *
+ * @~german
+ * @brief Die Konfiguration, bis der Server eine geliefert hat.
+ * @return Die Standardkonfiguration.
+ */
++ (Configuration *)defaultConfiguration;
+
+@end
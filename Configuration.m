@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "Configuration.h"
+#import "NameTable.h"
+
+static NSNumber *numberForKey(NSDictionary *dictionary, NSString *key, double minimum, double maximum) {
+
+  id value = [dictionary objectForKey:key];
+  if ( ![value isKindOfClass:[NSNumber class]] ) {
+
+    return nil;
+  }
+  double number = [value doubleValue];
+  if ( number < minimum || number > maximum ) {
+
+    return nil;
+  }
+  return value;
+}
+
+@implementation Configuration
+
+@synthesize batchSize;
+@synthesize flushCount;
+@synthesize flushInterval;
+@synthesize sampling;
+@synthesize disabledActions;
+@synthesize compression;
+@synthesize serverFilePaths;
+@synthesize maxAge;
+
+- (id)init { return [self initWithDictionary:nil]; }
+
+- (id)initWithDictionary:(NSDictionary *)dictionary {
+
+  if ( ( self = [super init] ) ) {
+
+    if ( ![dictionary isKindOfClass:[NSDictionary class]] ) {
+
+      dictionary = nil;
+    }
+
+    NSNumber *number = numberForKey(dictionary, @"batchSize", 0, 100000);
+    batchSize = number != nil ? [number unsignedIntegerValue] : 0;
+
+    number = numberForKey(dictionary, @"flushCount", 1, UINT32_MAX);
+    flushCount = number != nil ? [number unsignedIntValue] : 1024;
+
+    number = numberForKey(dictionary, @"flushInterval", 1, 86400);
+    flushInterval = number != nil ? [number doubleValue] : 300.0;
+
+    number = numberForKey(dictionary, @"sampling", 0, 1);
+    sampling = number != nil ? [number doubleValue] : 1.0;
+
+    number = numberForKey(dictionary, @"compression", 0, 1);
+    compression = [number boolValue];
+
+    /* never revalidate more often than every 5 minutes */
+    number = numberForKey(dictionary, @"maxAge", 300, 7 * 86400);
+    maxAge = number != nil ? [number doubleValue] : 6 * 3600.0;
+
+    NSMutableSet *actions = [[NSMutableSet alloc] init];
+    id values = [dictionary objectForKey:@"disabledActions"];
+    if ( [values isKindOfClass:[NSArray class]] ) {
+
+      for ( id action in values ) {
+
+        if ( [action isKindOfClass:[NSString class]] && [action length] > 0 ) {
+
+          [actions addObject:[NameTable escape:action]];
+        }
+      }
+    }
+    disabledActions = actions;
+
+    id paths = [dictionary objectForKey:@"serverFilePaths"];
+    if ( paths == nil ) {
+
+      paths = [dictionary objectForKey:@"serverFilePath"];
+    }
+    if ( [paths isKindOfClass:[NSString class]] ) {
+
+      paths = @[ paths ];
+    }
+    NSMutableArray *validPaths = [[NSMutableArray alloc] init];
+    if ( [paths isKindOfClass:[NSArray class]] ) {
+
+      for ( id path in paths ) {
+
+        if ( [path isKindOfClass:[NSString class]] && [path length] > 0 && [NSURL URLWithString:path] != nil ) {
+
+          [validPaths addObject:path];
+        }
+      }
+    }
+    serverFilePaths = [validPaths count] > 0 ? validPaths : nil;
+  }
+  return self;
+}
+
+- (BOOL)allowsAction:(NSString *)action {
+
+  if ( [disabledActions count] > 0 && [disabledActions containsObject:( [action length] > 0 ? action : @"page" )] ) {
+
+    return NO;
+  }
+  if ( sampling < 1.0 ) {
+
+    return arc4random_uniform(1000000) < ( uint32_t )( sampling * 1000000.0 );
+  }
+  return YES;
+}
+
++ (Configuration *)defaultConfiguration { return [[Configuration alloc] initWithDictionary:nil]; }
+
+@end
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* c header */
+#include <stdatomic.h>
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief Severity of a diagnostic message.
+ *
+ * @~german
+ * @brief Schweregrad einer Diagnosemeldung.
+ */
+typedef enum : int {
+
+  DiagnosticsLevelDebug = 0,
+  DiagnosticsLevelInfo,
+  DiagnosticsLevelWarning,
+  DiagnosticsLevelError,
+  DiagnosticsLevelNone
+} DiagnosticsLevel;
+
+/**
+ * @~english
+ * @brief Lowest level that is written to the console, fixed at compile time.
+ * Messages below are compiled out; their call site is still counted.
+ *
+ * @~german
+ * @brief Niedrigster Schweregrad, der auf der Konsole ausgegeben wird, zur
+ * Übersetzungszeit festgelegt. Meldungen darunter entfallen; ihre Aufrufstelle
+ * wird trotzdem gezählt.
+ */
+#ifndef DIAGNOSTICS_LEVEL
+#ifdef DEBUG
+#define DIAGNOSTICS_LEVEL DiagnosticsLevelInfo
+#else
+#define DIAGNOSTICS_LEVEL DiagnosticsLevelNone
+#endif
+#endif
+
+/**
+ * @~english
+ * @brief Number of messages per call site written before rate limiting.
+ *
+ * @~german
+ * @brief Anzahl der Meldungen pro Aufrufstelle vor der Begrenzung.
+ */
+#define DIAGNOSTICS_BURST 5
+
+/**
+ * @~english
+ * @brief After the burst, every n-th occurrence writes a summary.
+ *
+ * @~german
+ * @brief Nach den ersten Meldungen schreibt jedes n-te Auftreten eine
+ * Zusammenfassung.
+ */
+#define DIAGNOSTICS_PERIOD 1000
+
+/**
+ * @~english
+ * @brief Counter of one call site, registered on its first occurrence.
+ *
+ * @~german
+ * @brief Zähler einer Aufrufstelle, beim ersten Auftreten registriert.
+ */
+typedef struct DiagnosticsSite {
+
+  _Atomic(uint64_t) count;
+  const char *function;
+  int line;
+  DiagnosticsLevel level;
+  struct DiagnosticsSite *next;
+} DiagnosticsSite;
+
+/**
+ * @~english
+ * @brief Adds the call site to the list of queryable counters.
+ * @param site   The call site.
+ *
+ * @~german
+ * @brief Fügt die Aufrufstelle der Liste abfragbarer Zähler hinzu.
+ * @param site   Die Aufrufstelle.
+ */
+void diagnostics_register(DiagnosticsSite *site);
+
+/**
+ * @~english
+ * @brief Writes a message of the call site, if it is not rate limited.
+ * @param site   The call site.
+ * @param count   The occurrence returned by diagnostics_hit.
+ * @param message   The message.
+ *
+ * @~german
+ * @brief Gibt eine Meldung der Aufrufstelle aus, wenn sie nicht begrenzt ist.
+ * @param site   Die Aufrufstelle.
+ * @param count   Das von diagnostics_hit gelieferte Auftreten.
+ * @param message   Die Meldung.
+ */
+void diagnostics_emit(DiagnosticsSite *site, uint64_t count, NSString *message);
+
+/**
+ * @~english
+ * @brief Counts an occurrence of the call site.
+ * @param site   The call site.
+ * @return The number of occurrences including this one.
+ *
+ * @~german
+ * @brief Zählt ein Auftreten der Aufrufstelle.
+ * @param site   Die Aufrufstelle.
+ * @return Die Anzahl der Auftreten einschließlich diesem.
+ */
+static inline uint64_t diagnostics_hit(DiagnosticsSite *site) {
+
+  uint64_t count = atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed) + 1;
+  if ( count == 1 ) {
+
+    diagnostics_register(site);
+  }
+  return count;
+}
+
+/**
+ * @~english
+ * @brief Returns true, if the occurrence is written to the console.
+ * @param count   The occurrence returned by diagnostics_hit.
+ * @return True, for the first messages and every period.
+ *
+ * @~german
+ * @brief Gibt wahr zurück, wenn das Auftreten auf der Konsole ausgegeben wird.
+ * @param count   Das von diagnostics_hit gelieferte Auftreten.
+ * @return Wahr für die ersten Meldungen und jede Periode.
+ */
+static inline BOOL diagnostics_should_emit(uint64_t count) { return count <= DIAGNOSTICS_BURST || count % DIAGNOSTICS_PERIOD == 0; }
+
+/**
+ * @~english
+ * @brief Counts and, depending on level and rate, writes a diagnostic message
+ * of the current call site. The arguments are only evaluated when the message
+ * is written.
+ *
+ * @~german
+ * @brief Zählt und schreibt, abhängig von Schweregrad und Häufigkeit, eine
+ * Diagnosemeldung der aktuellen Aufrufstelle. Die Argumente werden nur
+ * ausgewertet, wenn die Meldung geschrieben wird.
+ *
+ * @~
+ * @code
+ * DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'touch' with empty 'action'");
+ * @endcode
+ */
+#define DIAGNOSTICS(level, format, ...) \
+  do { \
+    static DiagnosticsSite diagnosticsSite = { 0, __PRETTY_FUNCTION__, __LINE__, level, NULL }; \
+    uint64_t diagnosticsCount = diagnostics_hit(&diagnosticsSite); \
+    if ( ( level ) >= DIAGNOSTICS_LEVEL && diagnostics_should_emit(diagnosticsCount) ) { \
+      diagnostics_emit(&diagnosticsSite, diagnosticsCount, [NSString stringWithFormat:format, ##__VA_ARGS__]); \
+    } \
+  } while ( 0 )
+
+/**
+ * @~english
+ * @brief The Diagnostics class.
+ * Access to the counters of all diagnostic call sites that occurred, also in
+ * builds that write nothing to the console.
+ *
+ * @~german
+ * @brief Die Klasse Diagnostics.
+ * Zugriff auf die Zähler aller aufgetretenen Diagnose-Aufrufstellen, auch in
+ * Builds, die nichts auf der Konsole ausgeben.
+ */
+@interface Diagnostics : NSObject {}
+
+/**
+ * @~english
+ * @brief Returns the number of occurrences per call site.
+ * @return Dictionary of 'function:line' to number of occurrences.
+ *
+ * @~german
+ * @brief Gibt die Anzahl der Auftreten pro Aufrufstelle zurück.
+ * @return Dictionary von 'Funktion:Zeile' auf Anzahl der Auftreten.
+ */
++ (NSDictionary<NSString *, NSNumber *> *)counters;
+
+@end
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "Diagnostics.h"
+
+/* registered call sites, only ever prepended */
+static _Atomic(DiagnosticsSite *) m_diagnosticsSites;
+
+void diagnostics_register(DiagnosticsSite *site) {
+
+  DiagnosticsSite *head = atomic_load_explicit(&m_diagnosticsSites, memory_order_relaxed);
+  do {
+
+    site->next = head;
+  } while ( !atomic_compare_exchange_weak_explicit(&m_diagnosticsSites, &head, site, memory_order_release, memory_order_relaxed) );
+}
+
+void diagnostics_emit(DiagnosticsSite *site, uint64_t count, NSString *message) {
+
+  static const char *levels[] = { "Debug", "Info", "Warning", "Error", "" };
+  if ( count <= DIAGNOSTICS_BURST ) {
+
+    NSLog(@"%s %s %i: %@%s", levels[site->level], site->function, site->line, message, count == DIAGNOSTICS_BURST ? " (further messages are rate limited)" : "");
+  }
+  else {
+
+    NSLog(@"%s %s %i: %@ (%llu occurrences)", levels[site->level], site->function, site->line, message, ( unsigned long long )count);
+  }
+}
+
+@implementation Diagnostics
+
++ (NSDictionary<NSString *, NSNumber *> *)counters {
+
+  NSMutableDictionary *counters = [[NSMutableDictionary alloc] init];
+  for ( DiagnosticsSite *site = atomic_load_explicit(&m_diagnosticsSites, memory_order_acquire); site != NULL; site = site->next ) {
+
+    NSString *key = [NSString stringWithFormat:@"%s:%i", site->function, site->line];
+    [counters setObject:@(atomic_load_explicit(&site->count, memory_order_relaxed)) forKey:key];
+  }
+  return counters;
+}
+
+@end
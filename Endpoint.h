@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The Endpoint class.
+ * One statistics server with its health: exponentially weighted moving
+ * averages of the latency of accepted requests and of the error rate. A
+ * failed request costs as much as ten seconds of latency, so a server that
+ * fails fast does not win the selection. After three consecutive failures the
+ * endpoint is taken out of rotation and probed again with a single request
+ * after an exponentially growing delay of up to ten minutes.
+ *
+ * @~german
+ * @brief Die Klasse Endpoint.
+ * Ein Statistikserver mit seinem Zustand: exponentiell gewichtete gleitende
+ * Mittelwerte der Latenz angenommener Anfragen und der Fehlerrate. Eine
+ * fehlgeschlagene Anfrage kostet so viel wie zehn Sekunden Latenz, damit ein
+ * schnell fehlschlagender Server nicht gewählt wird. Nach drei
+ * aufeinanderfolgenden Fehlern wird der Server aus der Rotation genommen und
+ * nach einer exponentiell wachsenden Wartezeit von bis zu zehn Minuten mit
+ * einer einzelnen Anfrage erneut geprüft.
+ */
+@interface Endpoint : NSObject {
+
+@private
+  /**
+   * @~english
+   * @brief Number of failures in a row.
+   *
+   * @~german
+   * @brief Anzahl der Fehler in Folge.
+   */
+  NSUInteger m_consecutiveFailures;
+
+  /**
+   * @~english
+   * @brief Time before which the endpoint is not used.
+   *
+   * @~german
+   * @brief Zeitpunkt, vor dem der Server nicht verwendet wird.
+   */
+  NSTimeInterval m_retryAfter;
+}
+
+/**
+ * @~english
+ * @brief The path to the statistics server.
+ *
+ * @~german
+ * @brief Der Pfad zum Statistikserver.
+ */
+@property (nonatomic, readonly) NSURL *url;
+
+/**
+ * @~english
+ * @brief Average latency of accepted requests in seconds.
+ *
+ * @~german
+ * @brief Durchschnittliche Latenz angenommener Anfragen in Sekunden.
+ */
+@property (nonatomic, readonly) double latency;
+
+/**
+ * @~english
+ * @brief Average error rate between 0 and 1.
+ *
+ * @~german
+ * @brief Durchschnittliche Fehlerrate zwischen 0 und 1.
+ */
+@property (nonatomic, readonly) double errorRate;
+
+/**
+ * @~english
+ * @brief Number of requests sent to the endpoint.
+ *
+ * @~german
+ * @brief Anzahl der an den Server gesendeten Anfragen.
+ */
+@property (nonatomic, readonly) NSUInteger requests;
+
+/**
+ * @~english
+ * @brief Number of failed requests.
+ *
+ * @~german
+ * @brief Anzahl der fehlgeschlagenen Anfragen.
+ */
+@property (nonatomic, readonly) NSUInteger failures;
+
+/**
+ * @~english
+ * @brief Creates an endpoint.
+ * @param url   The path to the statistics server.
+ * @return The endpoint.
+ *
+ * @~german
+ * @brief Erstellt einen Server.
+ * @param url   Der Pfad zum Statistikserver.
+ * @return Der Server.
+ */
+- (id)initWithURL:(NSURL *)url;
+
+/**
+ * @~english
+ * @brief Returns true, if the endpoint is in rotation or due for a probe.
+ * @param now   The current time.
+ * @return True, if the endpoint can be used - otherwise false.
+ *
+ * @~german
+ * @brief Gibt wahr zurück, wenn der Server in Rotation ist oder erneut
+ * geprüft werden soll.
+ * @param now   Die aktuelle Zeit.
+ * @return Wahr, wenn der Server verwendet werden kann - sonst falsch.
+ */
+- (BOOL)isAvailable:(NSTimeInterval)now;
+
+/**
+ * @~english
+ * @brief Returns true, if the endpoint is out of rotation and due for a probe.
+ * @param now   The current time.
+ * @return True, if the next request is a probe - otherwise false.
+ *
+ * @~german
+ * @brief Gibt wahr zurück, wenn der Server außer Rotation ist und erneut
+ * geprüft werden soll.
+ * @param now   Die aktuelle Zeit.
+ * @return Wahr, wenn die nächste Anfrage eine Prüfung ist - sonst falsch.
+ */
+- (BOOL)isProbeDue:(NSTimeInterval)now;
+
+/**
+ * @~english
+ * @brief Marks the start of a request. Only one probe is sent at a time.
+ * @param now   The current time.
+ *
+ * @~german
+ * @brief Markiert den Beginn einer Anfrage. Es wird nur eine Prüfung
+ * gleichzeitig gesendet.
+ * @param now   Die aktuelle Zeit.
+ */
+- (void)willSend:(NSTimeInterval)now;
+
+/**
+ * @~english
+ * @brief Records the result of a request.
+ * @param success   True, if the server accepted the request.
+ * @param latency   Duration of the request in seconds.
+ * @param now   The current time.
+ *
+ * @~german
+ * @brief Erfasst das Ergebnis einer Anfrage.
+ * @param success   Wahr, wenn der Server die Anfrage angenommen hat.
+ * @param latency   Dauer der Anfrage in Sekunden.
+ * @param now   Die aktuelle Zeit.
+ */
+- (void)didFinish:(BOOL)success latency:(double)latency now:(NSTimeInterval)now;
+
+/**
+ * @~english
+ * @brief Score for selection, lower is better.
+ * @return Expected seconds of the next request, failures counted with a
+ * fixed cost.
+ *
+ * @~german
+ * @brief Bewertung für die Auswahl, kleiner ist besser.
+ * @return Erwartete Sekunden der nächsten Anfrage, Fehler mit festen Kosten
+ * gezählt.
+ */
+- (double)score;
+
+/**
+ * @~english
+ * @brief Current metrics of the endpoint.
+ * @return Dictionary with url, latency (ms), errorRate, requests, failures and
+ * available.
+ *
+ * @~german
+ * @brief Aktuelle Kennzahlen des Servers.
+ * @return Dictionary mit url, latency (ms), errorRate, requests, failures und
+ * available.
+ */
+- (NSDictionary<NSString *, id> *)metrics;
+
+@end
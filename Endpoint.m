@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "Endpoint.h"
+
+/* weight of the newest sample in the moving averages */
+static const double kEndpointAlpha = 0.2;
+
+/* cost of a failed request in seconds, like a request running into a timeout */
+static const double kEndpointFailureCost = 10.0;
+
+/* failures in a row before the endpoint leaves the rotation */
+static const NSUInteger kEndpointFailureLimit = 3;
+
+/* delay of the first probe, doubled per further failure */
+static const NSTimeInterval kEndpointProbeDelay = 10.0;
+static const NSTimeInterval kEndpointProbeDelayMax = 600.0;
+
+/* time an unanswered probe blocks further probes */
+static const NSTimeInterval kEndpointProbeTimeout = 60.0;
+
+@implementation Endpoint
+
+@synthesize url;
+@synthesize latency;
+@synthesize errorRate;
+@synthesize requests;
+@synthesize failures;
+
+- (id)initWithURL:(NSURL *)anURL {
+
+  if ( ( self = [super init] ) ) {
+
+    url = anURL;
+    latency = 0.0;
+    errorRate = 0.0;
+    requests = 0;
+    failures = 0;
+    m_consecutiveFailures = 0;
+    m_retryAfter = 0;
+  }
+  return self;
+}
+
+- (BOOL)isAvailable:(NSTimeInterval)now {
+
+  @synchronized ( self ) {
+
+    return m_consecutiveFailures < kEndpointFailureLimit || now >= m_retryAfter;
+  }
+}
+
+- (BOOL)isProbeDue:(NSTimeInterval)now {
+
+  @synchronized ( self ) {
+
+    return m_consecutiveFailures >= kEndpointFailureLimit && now >= m_retryAfter;
+  }
+}
+
+- (void)willSend:(NSTimeInterval)now {
+
+  @synchronized ( self ) {
+
+    requests++;
+    if ( m_consecutiveFailures >= kEndpointFailureLimit ) {
+
+      m_retryAfter = now + kEndpointProbeTimeout;
+    }
+  }
+}
+
+- (void)didFinish:(BOOL)success latency:(double)aLatency now:(NSTimeInterval)now {
+
+  @synchronized ( self ) {
+
+    /* fast failures must not make a server look fast, only accepted requests are timed */
+    errorRate += kEndpointAlpha * ( ( success ? 0.0 : 1.0 ) - errorRate );
+    if ( success ) {
+
+      /* first sample replaces the unmeasured zero */
+      latency = latency == 0.0 ? aLatency : latency + kEndpointAlpha * ( aLatency - latency );
+      m_consecutiveFailures = 0;
+      m_retryAfter = 0;
+      return;
+    }
+
+    failures++;
+    m_consecutiveFailures++;
+    if ( m_consecutiveFailures >= kEndpointFailureLimit ) {
+
+      NSUInteger exponent = MIN(m_consecutiveFailures - kEndpointFailureLimit, ( NSUInteger )16);
+      m_retryAfter = now + MIN(kEndpointProbeDelay * ( double )( 1 << exponent ), kEndpointProbeDelayMax);
+    }
+  }
+}
+
+- (double)score {
+
+  @synchronized ( self ) {
+
+    /* expected cost of the next request */
+    return ( 1.0 - errorRate ) * latency + errorRate * kEndpointFailureCost;
+  }
+}
+
+- (NSDictionary<NSString *, id> *)metrics {
+
+  @synchronized ( self ) {
+
+    return @{ @"url": [url absoluteString],
+              @"latency": @(latency * 1000.0),
+              @"errorRate": @(errorRate),
+              @"requests": @(requests),
+              @"failures": @(failures),
+              @"available": @(m_consecutiveFailures < kEndpointFailureLimit) };
+  }
+}
+
+@end
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* modules */
+@import Foundation;
+
+/* Maximum number of properties per event */
+#define EVENT_PROPERTIES_MAX 16
+
+/* Maximum length of a property key */
+#define EVENT_PROPERTIES_KEY_MAX 32
+
+/* Size of the encoded properties, enough for the budget of short values */
+#define EVENT_PROPERTIES_SIZE 4096
+
+/* Bytes kept inside the object, enough for a few numbers */
+#define EVENT_PROPERTIES_INLINE_SIZE 256
+
+/**
+ * @~english
+ * @brief The EventProperties class.
+ * Named, typed values of one event. Every value is encoded by its type
+ * directly into a byte buffer as '&properties[key]=value', so numbers are not
+ * formatted through NSString. The buffer starts inside the object and moves
+ * to the heap only when it grows past EVENT_PROPERTIES_INLINE_SIZE bytes, up
+ * to EVENT_PROPERTIES_SIZE bytes. Integers are written as is, doubles always
+ * contain a '.' or an exponent, booleans are 'true' or 'false' and strings
+ * are escaped and limited to 255 characters. Each event has a budget of
+ * EVENT_PROPERTIES_MAX properties; further properties are rejected.
+ *
+ * @~german
+ * @brief Die Klasse EventProperties.
+ * Benannte, typisierte Werte eines Events. Jeder Wert wird nach seinem Typ
+ * direkt in einen Bytepuffer als '&properties[key]=value' kodiert, Zahlen
+ * werden also nicht über NSString formatiert. Der Puffer liegt zunächst im
+ * Objekt und wandert erst auf den Heap, wenn er über
+ * EVENT_PROPERTIES_INLINE_SIZE Bytes wächst, bis zu EVENT_PROPERTIES_SIZE
+ * Bytes. Ganzzahlen werden unverändert geschrieben, Gleitkommazahlen enthalten
+ * immer einen '.' oder einen Exponenten, Wahrheitswerte sind 'true' oder
+ * 'false' und Zeichenketten werden maskiert und auf 255 Zeichen begrenzt. Jedes Event hat ein Budget von
+ * EVENT_PROPERTIES_MAX Eigenschaften; weitere werden abgelehnt.
+ *
+ * @~
+ * @code
+ * EventProperties *properties = [[EventProperties alloc] init];
+ * [properties setInteger:3 forKey:@"items"];
+ * [properties setDouble:12.75 forKey:@"total"];
+ * [properties setBool:YES forKey:@"coupon"];
+ * [[Statistics instance] event:@"checkout" properties:properties];
+ * @endcode
+ */
+@interface EventProperties : NSObject {
+
+@private
+  /**
+   * @~english
+   * @brief Storage for the first encoded bytes.
+   *
+   * @~german
+   * @brief Speicher für die ersten kodierten Bytes.
+   */
+  char m_inline[EVENT_PROPERTIES_INLINE_SIZE];
+
+  /**
+   * @~english
+   * @brief Encoded properties, not terminated. Points to m_inline or to
+   * the heap.
+   *
+   * @~german
+   * @brief Kodierte Eigenschaften, nicht terminiert. Zeigt auf m_inline oder
+   * auf den Heap.
+   */
+  char *m_buffer;
+
+  /**
+   * @~english
+   * @brief Size of the buffer.
+   *
+   * @~german
+   * @brief Größe des Puffers.
+   */
+  NSUInteger m_capacity;
+
+  /**
+   * @~english
+   * @brief Used bytes of the buffer.
+   *
+   * @~german
+   * @brief Belegte Bytes des Puffers.
+   */
+  NSUInteger m_length;
+
+  /**
+   * @~english
+   * @brief Number of encoded properties.
+   *
+   * @~german
+   * @brief Anzahl der kodierten Eigenschaften.
+   */
+  NSUInteger m_count;
+}
+
+/**
+ * @~english
+ * @brief Adds an integer.
+ * @param value   The value.
+ * @param key   Letters, digits, '_', '-' and '.', up to
+ * EVENT_PROPERTIES_KEY_MAX characters.
+ * @return True, if the property was added - otherwise false.
+ *
+ * @~german
+ * @brief Fügt eine Ganzzahl hinzu.
+ * @param value   Der Wert.
+ * @param key   Buchstaben, Ziffern, '_', '-' und '.', bis zu
+ * EVENT_PROPERTIES_KEY_MAX Zeichen.
+ * @return Wahr, wenn die Eigenschaft hinzugefügt wurde - sonst falsch.
+ */
+- (BOOL)setInteger:(int64_t)value forKey:(NSString *)key;
+
+/**
+ * @~english
+ * @brief Adds a double with full precision. NaN and infinity are rejected.
+ * @param value   The value.
+ * @param key   The key.
+ * @return True, if the property was added - otherwise false.
+ *
+ * @~german
+ * @brief Fügt eine Gleitkommazahl mit voller Genauigkeit hinzu. NaN und
+ * Unendlich werden abgelehnt.
+ * @param value   Der Wert.
+ * @param key   Der Schlüssel.
+ * @return Wahr, wenn die Eigenschaft hinzugefügt wurde - sonst falsch.
+ */
+- (BOOL)setDouble:(double)value forKey:(NSString *)key;
+
+/**
+ * @~english
+ * @brief Adds a boolean.
+ * @param value   The value.
+ * @param key   The key.
+ * @return True, if the property was added - otherwise false.
+ *
+ * @~german
+ * @brief Fügt einen Wahrheitswert hinzu.
+ * @param value   Der Wert.
+ * @param key   Der Schlüssel.
+ * @return Wahr, wenn die Eigenschaft hinzugefügt wurde - sonst falsch.
+ */
+- (BOOL)setBool:(BOOL)value forKey:(NSString *)key;
+
+/**
+ * @~english
+ * @brief Adds a string.
+ * @param value   The value, limited to 255 characters.
+ * @param key   The key.
+ * @return True, if the property was added - otherwise false.
+ *
+ * @~german
+ * @brief Fügt eine Zeichenkette hinzu.
+ * @param value   Der Wert, auf 255 Zeichen begrenzt.
+ * @param key   Der Schlüssel.
+ * @return Wahr, wenn die Eigenschaft hinzugefügt wurde - sonst falsch.
+ */
+- (BOOL)setString:(NSString *)value forKey:(NSString *)key;
+
+/**
+ * @~english
+ * @brief Number of added properties.
+ * @return Number of properties.
+ *
+ * @~german
+ * @brief Anzahl der hinzugefügten Eigenschaften.
+ * @return Anzahl der Eigenschaften.
+ */
+- (NSUInteger)count;
+
+/**
+ * @~english
+ * @brief The encoded properties without copying.
+ * @param length   Receives the number of bytes.
+ * @return The bytes, valid as long as the properties are not changed.
+ *
+ * @~german
+ * @brief Die kodierten Eigenschaften ohne Kopie.
+ * @param length   Erhält die Anzahl der Bytes.
+ * @return Die Bytes, gültig solange die Eigenschaften nicht geändert werden.
+ */
+- (const char *)bytes:(NSUInteger *)length;
+
+@end
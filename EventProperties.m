@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* sys header */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* local header */
+#import "Diagnostics.h"
+#import "EventProperties.h"
+
+@interface EventProperties (PrivateMethods)
+- (char *)beginKey:(NSString *)key reserve:(NSUInteger)reserve;
+- (void)commit:(char *)end;
+@end
+
+@implementation EventProperties
+
+- (id)init {
+
+  if ( ( self = [super init] ) ) {
+
+    m_buffer = m_inline;
+    m_capacity = sizeof(m_inline);
+    m_length = 0;
+    m_count = 0;
+  }
+  return self;
+}
+
+- (void)dealloc {
+
+  if ( m_buffer != m_inline ) {
+
+    free(m_buffer);
+  }
+}
+
+- (BOOL)setInteger:(int64_t)value forKey:(NSString *)key {
+
+  char *output = [self beginKey:key reserve:21];
+  if ( output == NULL ) {
+
+    return NO;
+  }
+  [self commit:output + snprintf(output, 21, "%lld", ( long long )value)];
+  return YES;
+}
+
+- (BOOL)setDouble:(double)value forKey:(NSString *)key {
+
+  if ( !isfinite(value) ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - property '%@' is not a finite number", key);
+    return NO;
+  }
+  char *output = [self beginKey:key reserve:25];
+  if ( output == NULL ) {
+
+    return NO;
+  }
+
+  /* 17 significant digits survive the round trip, the '.' keeps the type */
+  int length = snprintf(output, 25, "%.17g", value);
+  if ( strpbrk(output, ".e") == NULL ) {
+
+    output[length++] = '.';
+    output[length++] = '0';
+  }
+  [self commit:output + length];
+  return YES;
+}
+
+- (BOOL)setBool:(BOOL)value forKey:(NSString *)key {
+
+  char *output = [self beginKey:key reserve:5];
+  if ( output == NULL ) {
+
+    return NO;
+  }
+  const char *text = value ? "true" : "false";
+  size_t length = strlen(text);
+  memcpy(output, text, length);
+  [self commit:output + length];
+  return YES;
+}
+
+- (BOOL)setString:(NSString *)value forKey:(NSString *)key {
+
+  NSUInteger length = [value length];
+  if ( length > 255 ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - property '%@' is larger than 255 signs", key);
+    length = [value rangeOfComposedCharacterSequencesForRange:NSMakeRange(255, 1)].location;
+  }
+
+  /* at most 255 characters of 3 UTF-8 bytes, each escaped to at most 4 bytes */
+  char raw[255 * 3];
+  NSUInteger used = 0;
+  [value getBytes:raw maxLength:sizeof(raw) usedLength:&used encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, length) remainingRange:NULL];
+  NSUInteger escaped = used;
+  for ( NSUInteger x = 0; x < used; ++x ) {
+
+    if ( raw[x] == '&' || raw[x] == '\'' || raw[x] == '|' ) {
+
+      escaped += 3;
+    }
+  }
+
+  char *output = [self beginKey:key reserve:escaped];
+  if ( output == NULL ) {
+
+    return NO;
+  }
+
+  /* same escaping as NameTable#escape: */
+  for ( NSUInteger x = 0; x < used; ++x ) {
+
+    switch ( raw[x] ) {
+
+      case '&':
+        memcpy(output, "%26", 3);
+        output += 3;
+        break;
+      case '\'':
+        memcpy(output, "%2F'", 4);
+        output += 4;
+        break;
+      case '|':
+        memcpy(output, "%7C", 3);
+        output += 3;
+        break;
+      default:
+        *output++ = raw[x];
+        break;
+    }
+  }
+  [self commit:output];
+  return YES;
+}
+
+- (NSUInteger)count { return m_count; }
+
+- (const char *)bytes:(NSUInteger *)length {
+
+  if ( length != NULL ) {
+
+    *length = m_length;
+  }
+  return m_buffer;
+}
+
+- (char *)beginKey:(NSString *)key reserve:(NSUInteger)reserve {
+
+  if ( m_count >= EVENT_PROPERTIES_MAX ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - property '%@' exceeds the budget of %d properties", key, EVENT_PROPERTIES_MAX);
+    return NULL;
+  }
+
+  char name[EVENT_PROPERTIES_KEY_MAX + 1];
+  if ( [key length] == 0 || ![key getCString:name maxLength:sizeof(name) encoding:NSASCIIStringEncoding] ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - property key '%@' is empty, not ASCII or larger than %d signs", key, EVENT_PROPERTIES_KEY_MAX);
+    return NULL;
+  }
+  size_t length = strlen(name);
+  for ( size_t x = 0; x < length; ++x ) {
+
+    char sign = name[x];
+    if ( !( ( sign >= 'a' && sign <= 'z' ) || ( sign >= 'A' && sign <= 'Z' ) || ( sign >= '0' && sign <= '9' ) || sign == '_' || sign == '-' || sign == '.' ) ) {
+
+      DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - property key '%@' contains invalid signs", key);
+      return NULL;
+    }
+  }
+
+  /* '&properties[' + key + ']=' + value */
+  static const char prefix[] = "&properties[";
+  NSUInteger needed = sizeof(prefix) - 1 + length + 2 + reserve;
+  if ( m_length + needed > EVENT_PROPERTIES_SIZE ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - property '%@' exceeds %d bytes per event", key, EVENT_PROPERTIES_SIZE);
+    return NULL;
+  }
+  if ( m_length + needed > m_capacity ) {
+
+    /* most events fit inline, larger ones grow by doubling up to the limit */
+    NSUInteger capacity = MIN(MAX(2 * m_capacity, m_length + needed), ( NSUInteger )EVENT_PROPERTIES_SIZE);
+    char *buffer = m_buffer == m_inline ? malloc(capacity) : realloc(m_buffer, capacity);
+    if ( buffer == NULL ) {
+
+      return NULL;
+    }
+    if ( m_buffer == m_inline ) {
+
+      memcpy(buffer, m_inline, m_length);
+    }
+    m_buffer = buffer;
+    m_capacity = capacity;
+  }
+  char *output = m_buffer + m_length;
+  memcpy(output, prefix, sizeof(prefix) - 1);
+  output += sizeof(prefix) - 1;
+  memcpy(output, name, length);
+  output += length;
+  *output++ = ']';
+  *output++ = '=';
+  return output;
+}
+
+- (void)commit:(char *)end {
+
+  m_length = ( NSUInteger )( end - m_buffer );
+  m_count++;
+}
+
+@end
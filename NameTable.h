@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The NameTable class.
+ * Interns the small vocabulary of page and action names used by an app. The
+ * truncated and escaped form of each distinct name is computed only once. The
+ * table is bounded; the least recently used name is evicted when it is full.
+ *
+ * @~german
+ * @brief Die Klasse NameTable.
+ * Verwaltet das kleine Vokabular an Seiten- und Aktionsnamen einer Anwendung.
+ * Die gekürzte und maskierte Form jedes Namens wird nur einmal berechnet. Die
+ * Tabelle ist begrenzt; ist sie voll, wird der am längsten nicht verwendete
+ * Name verdrängt.
+ */
+@interface NameTable : NSObject {
+
+@private
+  /**
+   * @~english
+   * @brief Entries by raw name.
+   *
+   * @~german
+   * @brief Einträge nach unverändertem Namen.
+   */
+  NSMutableDictionary *m_entries;
+
+  /**
+   * @~english
+   * @brief Maximum number of entries.
+   *
+   * @~german
+   * @brief Maximale Anzahl an Einträgen.
+   */
+  NSUInteger m_capacity;
+
+  /**
+   * @~english
+   * @brief Logical time of the last lookup, used for eviction.
+   *
+   * @~german
+   * @brief Logische Zeit des letzten Zugriffs, für die Verdrängung.
+   */
+  uint64_t m_tick;
+}
+
+/**
+ * @~english
+ * @brief Creates a table holding at most capacity names.
+ * @param capacity   Maximum number of names.
+ * @return The table.
+ *
+ * @~german
+ * @brief Erstellt eine Tabelle für höchstens capacity Namen.
+ * @param capacity   Maximale Anzahl an Namen.
+ * @return Die Tabelle.
+ */
+- (id)initWithCapacity:(NSUInteger)capacity;
+
+/**
+ * @~english
+ * @brief Returns the escaped form of name, limited to 255 characters.
+ * @param name   The raw name.
+ * @return The escaped name or nil, if name is empty.
+ *
+ * @~german
+ * @brief Gibt die maskierte Form von name zurück, auf 255 Zeichen begrenzt.
+ * @param name   Der unveränderte Name.
+ * @return Der maskierte Name oder nil, wenn name leer ist.
+ */
+- (NSString *)escapedName:(NSString *)name;
+
+/**
+ * @~english
+ * @brief Number of names currently interned.
+ * @return Number of names.
+ *
+ * @~german
+ * @brief Anzahl der aktuell aufgenommenen Namen.
+ * @return Anzahl der Namen.
+ */
+- (NSUInteger)count;
+
+/**
+ * @~english
+ * @brief Escapes the reserved signs of the statistics protocol.
+ * @param value   The raw value.
+ * @return The escaped value.
+ *
+ * @~german
+ * @brief Maskiert die reservierten Zeichen des Statistikprotokolls.
+ * @param value   Der unveränderte Wert.
+ * @return Der maskierte Wert.
+ */
++ (NSString *)escape:(NSString *)value;
+
+@end
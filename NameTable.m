@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "NameTable.h"
+
+/* single interned name */
+@interface NameTableEntry : NSObject {
+
+@public
+  NSString *escaped;
+  uint64_t lastUse;
+}
+@end
+
+@implementation NameTableEntry
+@end
+
+@interface NameTable (PrivateMethods)
+- (NameTableEntry *)entryForName:(NSString *)name;
+- (void)evictLeastRecentlyUsed;
+@end
+
+@implementation NameTable
+
+- (id)init { return [self initWithCapacity:256]; }
+
+- (id)initWithCapacity:(NSUInteger)capacity {
+
+  if ( ( self = [super init] ) ) {
+
+    m_entries = [[NSMutableDictionary alloc] initWithCapacity:capacity];
+    m_capacity = capacity > 0 ? capacity : 1;
+    m_tick = 0;
+  }
+  return self;
+}
+
+- (NSString *)escapedName:(NSString *)name {
+
+  NameTableEntry *entry = [self entryForName:name];
+  return entry != nil ? entry->escaped : nil;
+}
+
+- (NSUInteger)count {
+
+  @synchronized ( self ) {
+
+    return [m_entries count];
+  }
+}
+
+- (NameTableEntry *)entryForName:(NSString *)name {
+
+  if ( [name length] == 0 ) {
+
+    return nil;
+  }
+
+  @synchronized ( self ) {
+
+    NameTableEntry *entry = [m_entries objectForKey:name];
+    if ( entry == nil ) {
+
+      if ( [m_entries count] >= m_capacity ) {
+
+        [self evictLeastRecentlyUsed];
+      }
+
+      entry = [[NameTableEntry alloc] init];
+      NSString *value = name;
+      if ( [value length] > 255 ) {
+
+        value = [value substringToIndex:255];
+      }
+      entry->escaped = [NameTable escape:value];
+      [m_entries setObject:entry forKey:[name copy]];
+    }
+    entry->lastUse = ++m_tick;
+    return entry;
+  }
+}
+
+- (void)evictLeastRecentlyUsed {
+
+  /* only runs on a miss with a full table, the vocabulary is small */
+  __block id oldestKey = nil;
+  __block uint64_t oldestUse = UINT64_MAX;
+  [m_entries enumerateKeysAndObjectsUsingBlock:^(id key, NameTableEntry *entry, BOOL *stop) {
+
+#pragma unused(stop)
+    if ( entry->lastUse < oldestUse ) {
+
+      oldestUse = entry->lastUse;
+      oldestKey = key;
+    }
+  }];
+  if ( oldestKey != nil ) {
+
+    [m_entries removeObjectForKey:oldestKey];
+  }
+}
+
++ (NSString *)escape:(NSString *)value {
+
+  value = [value stringByReplacingOccurrencesOfString:@"&" withString:@"%26"];
+  value = [value stringByReplacingOccurrencesOfString:@"'" withString:@"%2F'"];
+  value = [value stringByReplacingOccurrencesOfString:@"|" withString:@"%7C"];
+  return value;
+}
+
+@end
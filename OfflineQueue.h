@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#include "RingBuffer.h"
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The OfflineQueue class.
+ * Messages that could not be sent, stored in a ring buffer file inside the
+ * app group container. The host app and its extensions append to the same
+ * file; only the host app drains it. Messages of former versions stored in
+ * the settings are moved into the queue once, messages the queue does not
+ * take stay in the settings.
+ *
+ * @~german
+ * @brief Die Klasse OfflineQueue.
+ * Nicht versendete Nachrichten, abgelegt in einer Ringpufferdatei im
+ * App-Group-Container. Die Anwendung und ihre Erweiterungen schreiben in
+ * dieselbe Datei; nur die Anwendung leert sie. Nachrichten früherer Versionen
+ * aus den Einstellungen werden einmalig in die Queue übernommen, Nachrichten,
+ * die die Queue nicht aufnimmt, bleiben in den Einstellungen.
+ */
+@interface OfflineQueue : NSObject {
+
+@private
+  /**
+   * @~english
+   * @brief The shared ring buffer, NULL if the file could not be opened.
+   *
+   * @~german
+   * @brief Der gemeinsame Ringpuffer, NULL wenn die Datei nicht geöffnet
+   * werden konnte.
+   */
+  RingBuffer *m_ring;
+
+  /**
+   * @~english
+   * @brief Buffer for records taken from the ring.
+   *
+   * @~german
+   * @brief Puffer für aus dem Ring entnommene Einträge.
+   */
+  NSMutableData *m_record;
+}
+
+/**
+ * @~english
+ * @brief Opens the queue file at path.
+ * @param path   The ring buffer file.
+ * @return The queue.
+ *
+ * @~german
+ * @brief Öffnet die Queue-Datei unter path.
+ * @param path   Die Ringpufferdatei.
+ * @return Die Queue.
+ */
+- (id)initWithPath:(NSString *)path;
+
+/**
+ * @~english
+ * @brief Appends a message.
+ * @param message   The message.
+ * @return True, if the message was stored - otherwise false.
+ *
+ * @~german
+ * @brief Hängt eine Nachricht an.
+ * @param message   Die Nachricht.
+ * @return Wahr, wenn die Nachricht gespeichert wurde - sonst falsch.
+ */
+- (BOOL)push:(NSString *)message;
+
+/**
+ * @~english
+ * @brief Removes and returns the oldest message.
+ * @return The message or nil, if the queue is empty.
+ *
+ * @~german
+ * @brief Entfernt die älteste Nachricht und gibt sie zurück.
+ * @return Die Nachricht oder nil, wenn die Queue leer ist.
+ */
+- (NSString *)pop;
+
+/**
+ * @~english
+ * @brief Number of queued messages.
+ * @return Number of messages.
+ *
+ * @~german
+ * @brief Anzahl der Nachrichten in der Queue.
+ * @return Anzahl der Nachrichten.
+ */
+- (NSUInteger)count;
+
+/**
+ * @~english
+ * @brief Number of bytes used by queued messages.
+ * @return Number of bytes.
+ *
+ * @~german
+ * @brief Anzahl der von Nachrichten belegten Bytes.
+ * @return Anzahl der Bytes.
+ */
+- (uint64_t)size;
+
+/**
+ * @~english
+ * @brief Number of messages dropped because the queue was full.
+ * @return Number of dropped messages.
+ *
+ * @~german
+ * @brief Anzahl der verworfenen Nachrichten, weil die Queue voll war.
+ * @return Anzahl der verworfenen Nachrichten.
+ */
+- (uint64_t)dropped;
+
+/**
+ * @~english
+ * @brief Returns true, if the running process is an app extension.
+ * @return True, if the process is an extension - otherwise false.
+ *
+ * @~german
+ * @brief Gibt wahr zurück, wenn der laufende Prozess eine Erweiterung ist.
+ * @return Wahr, wenn der Prozess eine Erweiterung ist - sonst falsch.
+ */
++ (BOOL)isExtension;
+
+/**
+ * @~english
+ * @brief The queue shared via the group.com.vxstats.statistics container.
+ * @return Singleton of OfflineQueue.
+ *
+ * @~german
+ * @brief Die über den Container group.com.vxstats.statistics geteilte Queue.
+ * @return Einzige Instanz von OfflineQueue.
+ */
++ (OfflineQueue *)sharedQueue;
+
+@end
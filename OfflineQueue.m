@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "Diagnostics.h"
+#import "OfflineQueue.h"
+
+/* 4 MB of messages, roughly 8000 events */
+static const uint32_t kOfflineQueueCapacity = 4 * 1024 * 1024;
+
+@interface OfflineQueue (PrivateMethods)
+- (void)migrateUserDefaults;
+@end
+
+@implementation OfflineQueue
+
+- (id)initWithPath:(NSString *)path {
+
+  if ( ( self = [super init] ) ) {
+
+    m_ring = ring_buffer_open([path fileSystemRepresentation], kOfflineQueueCapacity);
+    m_record = [[NSMutableData alloc] initWithLength:RING_BUFFER_RECORD_MAX];
+    if ( m_ring == NULL ) {
+
+      DIAGNOSTICS(DiagnosticsLevelError, @"Offline queue '%@' could not be opened", path);
+    }
+  }
+  return self;
+}
+
+- (void)dealloc { ring_buffer_close(m_ring); }
+
+- (BOOL)push:(NSString *)message {
+
+  const char *bytes = [message UTF8String];
+  if ( bytes == NULL ) {
+
+    return NO;
+  }
+  return ring_buffer_push(m_ring, bytes, ( uint32_t )strlen(bytes)) == 0;
+}
+
+- (NSString *)pop {
+
+  @synchronized ( self ) {
+
+    uint32_t length = 0;
+    while ( ring_buffer_pop(m_ring, [m_record mutableBytes], &length) == 1 ) {
+
+      NSString *message = [[NSString alloc] initWithBytes:[m_record bytes] length:length encoding:NSUTF8StringEncoding];
+      if ( message != nil ) {
+
+        return message;
+      }
+    }
+    return nil;
+  }
+}
+
+- (NSUInteger)count { return ( NSUInteger )ring_buffer_count(m_ring); }
+- (uint64_t)size { return ring_buffer_size(m_ring); }
+- (uint64_t)dropped { return ring_buffer_dropped(m_ring); }
+
+- (void)migrateUserDefaults {
+
+  NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"group.com.vxstats.statistics"];
+  NSArray *messages = [userDefaults objectForKey:@"offline"];
+  if ( messages == nil ) {
+
+    return;
+  }
+  /* messages the ring does not take stay in the settings, the app sends them from there */
+  NSMutableArray *remaining = [[NSMutableArray alloc] init];
+  for ( id message in messages ) {
+
+    if ( [message isKindOfClass:[NSString class]] && ![self push:message] ) {
+
+      [remaining addObject:message];
+    }
+  }
+  if ( [remaining count] > 0 ) {
+
+    [userDefaults setObject:remaining forKey:@"offline"];
+  }
+  else {
+
+    [userDefaults removeObjectForKey:@"offline"];
+  }
+  [userDefaults synchronize];
+}
+
++ (BOOL)isExtension { return [[[NSBundle mainBundle] bundlePath] hasSuffix:@".appex"]; }
+
++ (OfflineQueue *)sharedQueue {
+
+  static OfflineQueue *queue = nil;
+  static dispatch_once_t once;
+  dispatch_once(&once, ^{
+
+    NSURL *directory = [[NSFileManager defaultManager] containerURLForSecurityApplicationGroupIdentifier:@"group.com.vxstats.statistics"];
+    if ( directory == nil ) {
+
+      /* no app group entitlement, the queue is private to this app */
+      directory = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+      directory = [directory URLByAppendingPathComponent:@"com.vxstats.statistics" isDirectory:YES];
+      [[NSFileManager defaultManager] createDirectoryAtURL:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+    queue = [[OfflineQueue alloc] initWithPath:[[directory URLByAppendingPathComponent:@"offline.queue"] path]];
+    if ( ![OfflineQueue isExtension] ) {
+
+      [queue migrateUserDefaults];
+    }
+  });
+  return queue;
+}
+
+@end
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* sys header */
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* local header */
+#include "RingBuffer.h"
+
+#define RING_BUFFER_MAGIC 0x56585142 /* VXQB */
+#define RING_BUFFER_VERSION 1
+
+/* shared layout at the start of the file, followed by the data area */
+typedef struct {
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  uint32_t reserved;
+  /* byte offsets, only growing, position is offset % capacity */
+  volatile uint64_t head;
+  volatile uint64_t tail;
+  volatile uint64_t count;
+  volatile uint64_t dropped;
+} RingBufferHeader;
+
+struct RingBuffer {
+
+  int fd;
+  size_t mappedSize;
+  RingBufferHeader *header;
+  uint8_t *data;
+  pthread_mutex_t mutex;
+};
+
+static int lock(RingBuffer *ring) {
+
+  pthread_mutex_lock(&ring->mutex);
+  while ( flock(ring->fd, LOCK_EX) != 0 ) {
+
+    if ( errno != EINTR ) {
+
+      pthread_mutex_unlock(&ring->mutex);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static void unlock(RingBuffer *ring) {
+
+  flock(ring->fd, LOCK_UN);
+  pthread_mutex_unlock(&ring->mutex);
+}
+
+static void copyIn(RingBuffer *ring, uint64_t offset, const void *source, uint32_t length) {
+
+  uint32_t capacity = ring->header->capacity;
+  uint32_t position = ( uint32_t )( offset % capacity );
+  uint32_t first = length < capacity - position ? length : capacity - position;
+  memcpy(ring->data + position, source, first);
+  memcpy(ring->data, ( const uint8_t * )source + first, length - first);
+}
+
+static void copyOut(RingBuffer *ring, uint64_t offset, void *destination, uint32_t length) {
+
+  uint32_t capacity = ring->header->capacity;
+  uint32_t position = ( uint32_t )( offset % capacity );
+  uint32_t first = length < capacity - position ? length : capacity - position;
+  memcpy(destination, ring->data + position, first);
+  memcpy(( uint8_t * )destination + first, ring->data, length - first);
+}
+
+RingBuffer *ring_buffer_open(const char *path, uint32_t capacity) {
+
+  if ( path == NULL || capacity < 2 * ( RING_BUFFER_RECORD_MAX + sizeof(uint32_t) ) ) {
+
+    return NULL;
+  }
+
+  int fd = open(path, O_RDWR | O_CREAT, 0600);
+  if ( fd < 0 ) {
+
+    return NULL;
+  }
+  if ( flock(fd, LOCK_EX) != 0 ) {
+
+    close(fd);
+    return NULL;
+  }
+
+  /* an existing valid file keeps its capacity, anything else is recreated */
+  RingBufferHeader existing;
+  memset(&existing, 0, sizeof(existing));
+  struct stat status;
+  int valid = fstat(fd, &status) == 0 &&
+              pread(fd, &existing, sizeof(existing), 0) == ( ssize_t )sizeof(existing) &&
+              existing.magic == RING_BUFFER_MAGIC &&
+              existing.version == RING_BUFFER_VERSION &&
+              existing.capacity >= 2 * ( RING_BUFFER_RECORD_MAX + sizeof(uint32_t) ) &&
+              ( uint64_t )status.st_size == sizeof(RingBufferHeader) + ( uint64_t )existing.capacity;
+  if ( valid ) {
+
+    capacity = existing.capacity;
+  }
+  else if ( ftruncate(fd, 0) != 0 || ftruncate(fd, ( off_t )( sizeof(RingBufferHeader) + capacity )) != 0 ) {
+
+    flock(fd, LOCK_UN);
+    close(fd);
+    return NULL;
+  }
+
+  size_t mappedSize = sizeof(RingBufferHeader) + capacity;
+  void *memory = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if ( memory == MAP_FAILED ) {
+
+    flock(fd, LOCK_UN);
+    close(fd);
+    return NULL;
+  }
+
+  RingBuffer *ring = calloc(1, sizeof(RingBuffer));
+  if ( ring == NULL ) {
+
+    munmap(memory, mappedSize);
+    flock(fd, LOCK_UN);
+    close(fd);
+    return NULL;
+  }
+  ring->fd = fd;
+  ring->mappedSize = mappedSize;
+  ring->header = memory;
+  ring->data = ( uint8_t * )memory + sizeof(RingBufferHeader);
+  pthread_mutex_init(&ring->mutex, NULL);
+
+  if ( !valid ) {
+
+    ring->header->head = 0;
+    ring->header->tail = 0;
+    ring->header->count = 0;
+    ring->header->dropped = 0;
+    ring->header->capacity = capacity;
+    ring->header->version = RING_BUFFER_VERSION;
+    ring->header->reserved = 0;
+    /* magic last, a half initialized file is recreated on the next open */
+    __sync_synchronize();
+    ring->header->magic = RING_BUFFER_MAGIC;
+  }
+  flock(fd, LOCK_UN);
+  return ring;
+}
+
+void ring_buffer_close(RingBuffer *ring) {
+
+  if ( ring == NULL ) {
+
+    return;
+  }
+  munmap(ring->header, ring->mappedSize);
+  close(ring->fd);
+  pthread_mutex_destroy(&ring->mutex);
+  free(ring);
+}
+
+int ring_buffer_push(RingBuffer *ring, const void *data, uint32_t length) {
+
+  if ( ring == NULL || length > RING_BUFFER_RECORD_MAX || lock(ring) != 0 ) {
+
+    return -1;
+  }
+
+  RingBufferHeader *header = ring->header;
+  uint64_t needed = sizeof(uint32_t) + ( uint64_t )length;
+  uint64_t head = header->head;
+  uint64_t count = header->count;
+  uint64_t dropped = 0;
+  while ( header->tail - head + needed > header->capacity && head != header->tail ) {
+
+    uint32_t oldest = 0;
+    copyOut(ring, head, &oldest, sizeof(oldest));
+    head += sizeof(uint32_t) + oldest;
+    count = count > 0 ? count - 1 : 0;
+    dropped++;
+  }
+
+  if ( dropped > 0 ) {
+
+    /* release the dropped records before their space is overwritten */
+    header->head = head;
+    header->count = count;
+    header->dropped += dropped;
+    __sync_synchronize();
+  }
+
+  copyIn(ring, header->tail, &length, sizeof(length));
+  copyIn(ring, header->tail + sizeof(uint32_t), data, length);
+
+  /* the tail publishes the record only after its bytes are in place */
+  __sync_synchronize();
+  header->tail += needed;
+  __sync_synchronize();
+  header->count = count + 1;
+  unlock(ring);
+  return 0;
+}
+
+int ring_buffer_pop(RingBuffer *ring, void *buffer, uint32_t *length) {
+
+  if ( ring == NULL || buffer == NULL || length == NULL || lock(ring) != 0 ) {
+
+    return -1;
+  }
+
+  RingBufferHeader *header = ring->header;
+  if ( header->head == header->tail ) {
+
+    /* head and tail are authoritative, a writer may have died before the count */
+    header->count = 0;
+    unlock(ring);
+    return 0;
+  }
+
+  uint32_t recordLength = 0;
+  copyOut(ring, header->head, &recordLength, sizeof(recordLength));
+  if ( recordLength > RING_BUFFER_RECORD_MAX || header->tail - header->head < sizeof(uint32_t) + ( uint64_t )recordLength ) {
+
+    /* damaged file, start over instead of returning garbage */
+    header->head = header->tail;
+    header->count = 0;
+    unlock(ring);
+    return -1;
+  }
+  copyOut(ring, header->head + sizeof(uint32_t), buffer, recordLength);
+  *length = recordLength;
+
+  __sync_synchronize();
+  header->head += sizeof(uint32_t) + recordLength;
+  __sync_synchronize();
+  header->count = header->head == header->tail ? 0 : ( header->count > 0 ? header->count - 1 : 0 );
+  unlock(ring);
+  return 1;
+}
+
+uint64_t ring_buffer_count(RingBuffer *ring) { return ring != NULL ? ring->header->count : 0; }
+uint64_t ring_buffer_size(RingBuffer *ring) { return ring != NULL ? ring->header->tail - ring->header->head : 0; }
+uint64_t ring_buffer_dropped(RingBuffer *ring) { return ring != NULL ? ring->header->dropped : 0; }
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+/* c header */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @~english
+ * @brief Largest record accepted by ring_buffer_push.
+ *
+ * @~german
+ * @brief Größter von ring_buffer_push akzeptierter Eintrag.
+ */
+#define RING_BUFFER_RECORD_MAX 65536
+
+/**
+ * @~english
+ * @brief A file backed ring buffer of records, shared between processes.
+ * The file is mapped into memory; writers and readers are serialized with
+ * flock, which the kernel releases if a process dies while holding it, and
+ * with a mutex between threads of the same process. Dropped records are
+ * released before their space is reused and a new record only becomes
+ * visible when the tail moves past its complete bytes, so an interrupted
+ * writer never leaves a partial record behind. The record count follows the
+ * tail and is repaired whenever the buffer runs empty. When the buffer is
+ * full the oldest records are dropped and counted.
+ * @note Plain POSIX, used on Apple platforms and testable on Linux.
+ *
+ * @~german
+ * @brief Ein dateibasierter Ringpuffer für Einträge, gemeinsam genutzt von
+ * mehreren Prozessen. Die Datei wird in den Speicher eingeblendet; Schreiber
+ * und Leser werden mit flock synchronisiert, das der Kernel beim Absturz
+ * eines Prozesses freigibt, sowie mit einem Mutex zwischen Threads desselben
+ * Prozesses. Verworfene Einträge werden freigegeben, bevor ihr Platz neu
+ * belegt wird, und ein neuer Eintrag wird erst sichtbar, wenn das Ende hinter
+ * seine vollständigen Bytes verschoben wird; ein unterbrochener Schreiber
+ * hinterlässt daher keine halben Einträge. Die Anzahl folgt dem Ende und wird
+ * korrigiert, sobald der Puffer leer ist. Ist der Puffer voll, werden die
+ * ältesten Einträge verworfen und gezählt.
+ * @note Reines POSIX, verwendet auf Apple-Plattformen und testbar unter Linux.
+ */
+typedef struct RingBuffer RingBuffer;
+
+/**
+ * @~english
+ * @brief Opens or creates the ring buffer file at path.
+ * @param path   The file, e.g. inside the app group container.
+ * @param capacity   Size of the data area in bytes if the file is created.
+ * @return The ring buffer or NULL on failure.
+ *
+ * @~german
+ * @brief Öffnet oder erstellt die Ringpufferdatei unter path.
+ * @param path   Die Datei, z.B. im App-Group-Container.
+ * @param capacity   Größe des Datenbereichs in Bytes, wenn die Datei erstellt
+ * wird.
+ * @return Der Ringpuffer oder NULL bei einem Fehler.
+ */
+RingBuffer *ring_buffer_open(const char *path, uint32_t capacity);
+
+/**
+ * @~english
+ * @brief Unmaps and closes the ring buffer.
+ * @param ring   The ring buffer.
+ *
+ * @~german
+ * @brief Blendet den Ringpuffer aus und schließt ihn.
+ * @param ring   Der Ringpuffer.
+ */
+void ring_buffer_close(RingBuffer *ring);
+
+/**
+ * @~english
+ * @brief Appends a record, dropping the oldest records if necessary.
+ * @param ring   The ring buffer.
+ * @param data   The record.
+ * @param length   Length of the record, at most RING_BUFFER_RECORD_MAX.
+ * @return 0 on success, -1 if the record is too large or locking failed.
+ *
+ * @~german
+ * @brief Hängt einen Eintrag an und verwirft bei Bedarf die ältesten Einträge.
+ * @param ring   Der Ringpuffer.
+ * @param data   Der Eintrag.
+ * @param length   Länge des Eintrags, höchstens RING_BUFFER_RECORD_MAX.
+ * @return 0 bei Erfolg, -1 wenn der Eintrag zu groß ist oder das Sperren
+ * fehlschlug.
+ */
+int ring_buffer_push(RingBuffer *ring, const void *data, uint32_t length);
+
+/**
+ * @~english
+ * @brief Removes the oldest record.
+ * @param ring   The ring buffer.
+ * @param buffer   Receives the record, at least RING_BUFFER_RECORD_MAX bytes.
+ * @param length   Receives the length of the record.
+ * @return 1 if a record was removed, 0 if the buffer is empty, -1 on failure.
+ *
+ * @~german
+ * @brief Entfernt den ältesten Eintrag.
+ * @param ring   Der Ringpuffer.
+ * @param buffer   Erhält den Eintrag, mindestens RING_BUFFER_RECORD_MAX Bytes.
+ * @param length   Erhält die Länge des Eintrags.
+ * @return 1 wenn ein Eintrag entfernt wurde, 0 wenn der Puffer leer ist, -1
+ * bei einem Fehler.
+ */
+int ring_buffer_pop(RingBuffer *ring, void *buffer, uint32_t *length);
+
+/**
+ * @~english
+ * @brief Number of records in the buffer.
+ * @param ring   The ring buffer.
+ * @return Number of records.
+ *
+ * @~german
+ * @brief Anzahl der Einträge im Puffer.
+ * @param ring   Der Ringpuffer.
+ * @return Anzahl der Einträge.
+ */
+uint64_t ring_buffer_count(RingBuffer *ring);
+
+/**
+ * @~english
+ * @brief Number of bytes used by records in the buffer.
+ * @param ring   The ring buffer.
+ * @return Number of bytes.
+ *
+ * @~german
+ * @brief Anzahl der von Einträgen belegten Bytes im Puffer.
+ * @param ring   Der Ringpuffer.
+ * @return Anzahl der Bytes.
+ */
+uint64_t ring_buffer_size(RingBuffer *ring);
+
+/**
+ * @~english
+ * @brief Number of records dropped because the buffer was full.
+ * @param ring   The ring buffer.
+ * @return Number of dropped records since the file was created.
+ *
+ * @~german
+ * @brief Anzahl der verworfenen Einträge, weil der Puffer voll war.
+ * @param ring   Der Ringpuffer.
+ * @return Anzahl der verworfenen Einträge seit Erstellung der Datei.
+ */
+uint64_t ring_buffer_dropped(RingBuffer *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RINGBUFFER_H */
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/*
+ * Replaces App.m in the simulation and load test builds. The harnesses have
+ * no App Store receipt to verify, so they are built without OpenSSL and
+ * report no fair use; everything else reads the bundle like App.m.
+ */
+
+/* local header */
+#import "../App.h"
+
+static App *m_appInstance;
+
+@implementation App
+
++ (BOOL)fairUse { return NO; }
++ (NSString *)name { return [[NSBundle mainBundle] objectForInfoDictionaryKey:(NSString *)kCFBundleExecutableKey]; }
++ (NSString *)version { return [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleShortVersionString"]; }
++ (NSString *)build { return [[NSBundle mainBundle] objectForInfoDictionaryKey:@"CFBundleVersion"]; }
++ (NSString *)identifier { return [[NSBundle mainBundle] objectForInfoDictionaryKey:(NSString *)kCFBundleIdentifierKey]; }
+
++ (App *)currentApp {
+
+  if ( m_appInstance == nil ) {
+
+    m_appInstance = [[App alloc] init];
+  }
+  return m_appInstance;
+}
+
+@end
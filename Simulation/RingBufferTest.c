@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/*
+ * Multi-process test of the ring buffer, plain POSIX and not part of the SDK
+ * target. Several writer processes push numbered records while a reader
+ * process pops them, the buffer wraps and drops the oldest records, and
+ * writers are killed while they hold the lock.
+ *
+ *   cc -O2 -Wall -o ringbuffertest Simulation/RingBufferTest.c RingBuffer.c && ./ringbuffertest
+ */
+
+/* sys header */
+#include <sys/wait.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* local header */
+#include "../RingBuffer.h"
+
+#define WRITERS 8
+#define RECORDS 20000
+
+/* writer, sequence number and a payload derived from both */
+typedef struct {
+
+  uint32_t writer;
+  uint32_t sequence;
+} Record;
+
+static uint32_t encode(uint8_t *buffer, uint32_t writer, uint32_t sequence) {
+
+  Record record = { writer, sequence };
+  uint32_t payload = ( sequence * 7 + writer ) % 200;
+  memcpy(buffer, &record, sizeof(record));
+  memset(buffer + sizeof(record), ( int )( ( writer + sequence ) & 0xff ), payload);
+  return sizeof(record) + payload;
+}
+
+static int decode(const uint8_t *buffer, uint32_t length, Record *record) {
+
+  if ( length < sizeof(Record) ) {
+
+    return 0;
+  }
+  memcpy(record, buffer, sizeof(Record));
+  uint32_t payload = ( record->sequence * 7 + record->writer ) % 200;
+  if ( record->writer >= WRITERS || length != sizeof(Record) + payload ) {
+
+    return 0;
+  }
+  for ( uint32_t x = 0; x < payload; ++x ) {
+
+    if ( buffer[sizeof(Record) + x] != ( ( record->writer + record->sequence ) & 0xff ) ) {
+
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static int concurrent(const char *path) {
+
+  unlink(path);
+  RingBuffer *ring = ring_buffer_open(path, 16 * 1024 * 1024);
+  if ( ring == NULL ) {
+
+    return 1;
+  }
+  pid_t writers[WRITERS];
+  for ( uint32_t w = 0; w < WRITERS; ++w ) {
+
+    writers[w] = fork();
+    if ( writers[w] == 0 ) {
+
+      /* a fresh mapping per process like an app and its extensions */
+      RingBuffer *own = ring_buffer_open(path, 16 * 1024 * 1024);
+      uint8_t buffer[RING_BUFFER_RECORD_MAX];
+      for ( uint32_t s = 0; s < RECORDS; ++s ) {
+
+        if ( own == NULL || ring_buffer_push(own, buffer, encode(buffer, w, s)) != 0 ) {
+
+          _exit(1);
+        }
+      }
+      ring_buffer_close(own);
+      _exit(0);
+    }
+  }
+
+  /* read while the writers are running, every writer's records arrive in order */
+  uint32_t next[WRITERS] = { 0 };
+  uint32_t received = 0;
+  uint32_t damaged = 0;
+  uint32_t outOfOrder = 0;
+  uint8_t buffer[RING_BUFFER_RECORD_MAX];
+  int running = WRITERS;
+  while ( running > 0 || ring_buffer_size(ring) > 0 ) {
+
+    uint32_t length = 0;
+    int result = ring_buffer_pop(ring, buffer, &length);
+    if ( result == 1 ) {
+
+      Record record;
+      if ( !decode(buffer, length, &record) ) {
+
+        damaged++;
+      }
+      else {
+
+        if ( record.sequence != next[record.writer] ) {
+
+          outOfOrder++;
+        }
+        next[record.writer] = record.sequence + 1;
+        received++;
+      }
+    }
+    else if ( result < 0 ) {
+
+      damaged++;
+    }
+    while ( running > 0 && waitpid(-1, NULL, WNOHANG) > 0 ) {
+
+      running--;
+    }
+  }
+
+  int failed = received != WRITERS * RECORDS || damaged != 0 || outOfOrder != 0 || ring_buffer_dropped(ring) != 0 || ring_buffer_count(ring) != 0;
+  printf("%-10s %s  %u of %u received, %u damaged, %u out of order, %llu dropped\n", "concurrent", failed ? "FAIL" : "ok",
+         received, WRITERS * RECORDS, damaged, outOfOrder, ( unsigned long long )ring_buffer_dropped(ring));
+  ring_buffer_close(ring);
+  unlink(path);
+  return failed;
+}
+
+static int wrap(const char *path) {
+
+  /* the smallest buffer, overrun many times by one writer */
+  unlink(path);
+  uint32_t capacity = 2 * ( RING_BUFFER_RECORD_MAX + sizeof(uint32_t) );
+  RingBuffer *ring = ring_buffer_open(path, capacity);
+  if ( ring == NULL ) {
+
+    return 1;
+  }
+  uint8_t buffer[RING_BUFFER_RECORD_MAX];
+  uint32_t pushed = 0;
+  for ( uint32_t s = 0; s < 50 * capacity / 100; ++s ) {
+
+    if ( ring_buffer_push(ring, buffer, encode(buffer, 0, s)) == 0 ) {
+
+      pushed++;
+    }
+  }
+
+  /* the survivors are the newest records, contiguous and intact */
+  uint64_t dropped = ring_buffer_dropped(ring);
+  uint64_t count = ring_buffer_count(ring);
+  uint32_t expected = ( uint32_t )dropped;
+  uint32_t received = 0;
+  int intact = 1;
+  uint32_t length = 0;
+  while ( ring_buffer_pop(ring, buffer, &length) == 1 ) {
+
+    Record record;
+    intact = intact && decode(buffer, length, &record) && record.sequence == expected++;
+    received++;
+  }
+
+  int failed = !intact || dropped == 0 || dropped + received != pushed || count != received || ring_buffer_size(ring) != 0;
+  printf("%-10s %s  %u pushed, %llu dropped, %u received\n", "wrap", failed ? "FAIL" : "ok",
+         pushed, ( unsigned long long )dropped, received);
+  ring_buffer_close(ring);
+  unlink(path);
+  return failed;
+}
+
+static int interrupted(const char *path) {
+
+  /* writers killed at random points, the survivors are complete records */
+  unlink(path);
+  uint32_t capacity = 2 * ( RING_BUFFER_RECORD_MAX + sizeof(uint32_t) );
+  RingBuffer *ring = ring_buffer_open(path, capacity);
+  if ( ring == NULL ) {
+
+    return 1;
+  }
+  srand(( unsigned )getpid());
+  uint32_t damaged = 0;
+  uint32_t received = 0;
+  uint8_t buffer[RING_BUFFER_RECORD_MAX];
+  for ( int round = 0; round < 200; ++round ) {
+
+    pid_t writer = fork();
+    if ( writer == 0 ) {
+
+      RingBuffer *own = ring_buffer_open(path, capacity);
+      uint8_t record[RING_BUFFER_RECORD_MAX];
+      for ( uint32_t s = 0; own != NULL; ++s ) {
+
+        ring_buffer_push(own, record, encode(record, ( uint32_t )round % WRITERS, s));
+      }
+      _exit(1);
+    }
+    usleep(( useconds_t )( rand() % 2000 ));
+    kill(writer, SIGKILL);
+    waitpid(writer, NULL, 0);
+
+    /* take half of what is there, the rest is wrapped over by the next writer */
+    uint64_t half = ring_buffer_count(ring) / 2;
+    uint32_t length = 0;
+    for ( uint64_t x = 0; x < half; ++x ) {
+
+      Record record;
+      int result = ring_buffer_pop(ring, buffer, &length);
+      if ( result == 0 ) {
+
+        break;
+      }
+      if ( result < 0 || !decode(buffer, length, &record) ) {
+
+        damaged++;
+      }
+      received++;
+    }
+  }
+  uint32_t length = 0;
+  int result;
+  while ( ( result = ring_buffer_pop(ring, buffer, &length) ) != 0 ) {
+
+    Record record;
+    if ( result < 0 || !decode(buffer, length, &record) ) {
+
+      damaged++;
+    }
+    received++;
+  }
+
+  int failed = damaged != 0 || received == 0 || ring_buffer_count(ring) != 0;
+  printf("%-10s %s  %u received, %u damaged\n", "interrupt", failed ? "FAIL" : "ok", received, damaged);
+  ring_buffer_close(ring);
+  unlink(path);
+  return failed;
+}
+
+int main(int argc, char *argv[]) {
+
+  char path[256];
+  snprintf(path, sizeof(path), "%s/ringbuffertest.%d", argc > 1 ? argv[1] : "/tmp", ( int )getpid());
+  int failed = concurrent(path);
+  failed |= wrap(path);
+  failed |= interrupted(path);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+#
+# This document is property of VX STATS. It is strictly prohibited
+# to modify, sell or publish it in any way. In case you have access
+# to this document, you are obligated to ensure its nondisclosure.
+# Noncompliances will be prosecuted.
+#
+# Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+# oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+# Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+# alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+# Zuwiderhandlungen werden strafrechtlich verfolgt.
+#
+
+"""
+Local stand-in for the ingest server with fault injection, used by the load
+test in Simulation/load.m. It accepts every POST, counts the sequence numbers
+sent as 'properties[seq]' and answers GET /stats with the counters as JSON.
+With --configuration it serves that file as configuration.json with an ETag
+and answers matching If-None-Match requests with 304.
+
+  python3 Simulation/ingest.py --port 8080 --latency 20 --jitter 10 \
+    --errors 0.02 --resets 0.005 --slow 0.01 --slow-rate 4096 \
+    --configuration configuration.json
+"""
+
+import argparse
+import hashlib
+import json
+import random
+import signal
+import socket
+import struct
+import sys
+import threading
+import time
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qsl
+
+
+class Counters:
+
+    def __init__(self):
+
+        self.lock = threading.Lock()
+        self.seen = set()
+        self.requests = 0
+        self.delivered = 0
+        self.duplicated = 0
+        self.errors = 0
+        self.resets = 0
+        self.slow = 0
+        self.bytes = 0
+        self.configurations = 0
+        self.revalidations = 0
+
+    def snapshot(self):
+
+        with self.lock:
+            return {
+                'requests': self.requests,
+                'delivered': self.delivered,
+                'duplicated': self.duplicated,
+                'errors': self.errors,
+                'resets': self.resets,
+                'slow': self.slow,
+                'bytes': self.bytes,
+                'configurations': self.configurations,
+                'revalidations': self.revalidations,
+            }
+
+
+class Handler(BaseHTTPRequestHandler):
+
+    protocol_version = 'HTTP/1.1'
+    options = None
+    counters = None
+
+    def log_message(self, format, *args):
+
+        # one line per request would dominate the measured host
+        pass
+
+    def reset(self):
+
+        # SO_LINGER with zero timeout sends RST instead of FIN
+        self.connection.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack('ii', 1, 0))
+        self.connection.close()
+        self.close_connection = True
+
+    def respond(self, status, body=b'', content_type='text/plain'):
+
+        self.send_response(status)
+        self.send_header('content-type', content_type)
+        self.send_header('content-length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def read_body(self, slow):
+
+        length = int(self.headers.get('content-length', 0))
+        if not slow:
+            return self.rfile.read(length)
+
+        # a congested server drains its socket buffer slowly
+        body = b''
+        chunk = max(1, self.options.slow_rate // 10)
+        while len(body) < length:
+            body += self.rfile.read(min(chunk, length - len(body)))
+            time.sleep(0.1)
+        return body
+
+    def do_GET(self):
+
+        path = self.path.split('?')[0]
+        if path.rstrip('/').endswith('/stats'):
+            self.respond(200, json.dumps(self.counters.snapshot()).encode(), 'application/json')
+        elif path.endswith('/configuration.json') and self.options.configuration:
+            self.configuration()
+        else:
+            # no server-driven configuration, the SDK keeps its defaults
+            self.respond(404)
+
+    def configuration(self):
+
+        # read on every request, so the document can be changed while a test runs
+        with open(self.options.configuration, 'rb') as document:
+            body = document.read()
+        etag = '"%s"' % hashlib.sha1(body).hexdigest()[:16]
+        if self.headers.get('if-none-match') == etag:
+            with self.counters.lock:
+                self.counters.revalidations += 1
+            self.send_response(304)
+            self.send_header('ETag', etag)
+            self.send_header('content-length', '0')
+            self.end_headers()
+            return
+        with self.counters.lock:
+            self.counters.configurations += 1
+        self.send_response(200)
+        self.send_header('content-type', 'application/json')
+        self.send_header('ETag', etag)
+        self.send_header('content-length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_POST(self):
+
+        options = self.options
+        counters = self.counters
+        with counters.lock:
+            counters.requests += 1
+
+        if random.random() < options.resets:
+            with counters.lock:
+                counters.resets += 1
+            self.reset()
+            return
+
+        slow = random.random() < options.slow
+        body = self.read_body(slow)
+        if options.latency > 0 or options.jitter > 0:
+            time.sleep(max(0.0, random.gauss(options.latency, options.jitter)) / 1000.0)
+
+        if random.random() < options.errors:
+            with counters.lock:
+                counters.errors += 1
+            self.respond(503)
+            return
+
+        if self.headers.get('content-encoding') == 'deflate':
+            body = zlib.decompress(body)
+        sequence = None
+        for key, value in parse_qsl(body.decode('utf-8', 'replace'), keep_blank_values=True):
+            if key == 'properties[seq]':
+                sequence = value
+                break
+
+        with counters.lock:
+            counters.bytes += len(body)
+            if slow:
+                counters.slow += 1
+            if sequence is not None:
+                if sequence in counters.seen:
+                    counters.duplicated += 1
+                else:
+                    counters.seen.add(sequence)
+                    counters.delivered += 1
+        self.respond(200)
+
+
+def report(counters, interval):
+
+    previous = counters.snapshot()
+    while True:
+        time.sleep(interval)
+        current = counters.snapshot()
+        rate = (current['delivered'] - previous['delivered']) / interval
+        print('ingest  %(requests)10d requests %(delivered)10d delivered %(duplicated)8d duplicated '
+              '%(errors)8d 5xx %(resets)8d resets %(slow)8d slow' % current
+              + '  %.0f events/s' % rate, file=sys.stderr, flush=True)
+        previous = current
+
+
+def terminate(signum, frame):
+
+    # print the final counters like on ctrl-c
+    raise KeyboardInterrupt
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description='Ingest stand-in with fault injection.')
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=8080)
+    parser.add_argument('--latency', type=float, default=0.0, help='mean response latency in ms')
+    parser.add_argument('--jitter', type=float, default=0.0, help='standard deviation of the latency in ms')
+    parser.add_argument('--errors', type=float, default=0.0, help='share of requests answered with 503')
+    parser.add_argument('--resets', type=float, default=0.0, help='share of connections reset before the response')
+    parser.add_argument('--slow', type=float, default=0.0, help='share of requests read slowly')
+    parser.add_argument('--slow-rate', type=int, default=4096, help='bytes per second for slow reads')
+    parser.add_argument('--configuration', default=None, help='JSON document served as configuration.json')
+    parser.add_argument('--report', type=float, default=10.0, help='seconds between reports')
+    parser.add_argument('--seed', type=int, default=None)
+    options = parser.parse_args()
+
+    if options.seed is not None:
+        random.seed(options.seed)
+    Handler.options = options
+    Handler.counters = Counters()
+
+    server = ThreadingHTTPServer((options.host, options.port), Handler)
+    server.daemon_threads = True
+    threading.Thread(target=report, args=(Handler.counters, options.report), daemon=True).start()
+    signal.signal(signal.SIGTERM, terminate)
+    print('ingest  listening on http://%s:%d/' % (options.host, options.port), file=sys.stderr, flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print(json.dumps(Handler.counters.snapshot()), flush=True)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/*
+ * Soak and throughput test of the real delivery path: NSURLSession, offline
+ * queue and endpoint health against Simulation/ingest.py. Every event carries
+ * its sequence number and enqueue time as properties, so the ingest stand-in
+ * can count duplicates and this driver can measure enqueue to acknowledgement
+ * without keeping per-event state.
+ *
+ * Start the ingest stand-in, locally or on another host:
+ *   python3 Simulation/ingest.py --port 8080 --latency 20 --errors 0.02 --resets 0.005 --slow 0.01
+ *
+ * Build and run from the project folder:
+ *   clang -fobjc-arc -fmodules -O2 -I. Simulation/load.m Simulation/AppStub.m \
+ *     $(ls *.m | grep -v '^App\.m$') RingBuffer.c -framework SystemConfiguration -lz -o load
+ *   ./load -server http://127.0.0.1:8080/ -rate 1000 -duration 600
+ *
+ * Options (NSUserDefaults argument domain):
+ *   -server   Ingest URL, default http://127.0.0.1:8080/.
+ *   -rate   Events per second, default 500.
+ *   -duration   Seconds of load, default 300.
+ *   -report   Seconds between reports, default 10.
+ *   -drain   Seconds between simulated reconnects that drain the offline
+ *            queue, default 30.
+ *   -flush   Seconds for the final flush, default 30.
+ */
+
+/* sys header */
+#include <pthread.h>
+#include <sys/resource.h>
+
+/* modules */
+@import Foundation;
+
+/* local header */
+#import "../Clock.h"
+#import "../EventProperties.h"
+#import "../OfflineQueue.h"
+#import "../Statistics+Simulation.h"
+#include "../TraceHistogram.h"
+
+#pragma mark - State
+
+static pthread_mutex_t m_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TraceHistogram m_interval;
+static TraceHistogram m_total;
+static uint64_t m_enqueued = 0;
+static uint64_t m_acknowledged = 0;
+static uint64_t m_failed = 0;
+
+static int64_t integerProperty(NSString *message, NSString *key) {
+
+  NSRange range = [message rangeOfString:key];
+  if ( range.location == NSNotFound ) {
+
+    return -1;
+  }
+  const char *value = [[message substringFromIndex:NSMaxRange(range)] UTF8String];
+  return strtoll(value, NULL, 10);
+}
+
+static double cpuSeconds(void) {
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + ( usage.ru_utime.tv_usec + usage.ru_stime.tv_usec ) / 1e6;
+}
+
+static long maximumResidentSize(void) {
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static void report(const char *label, NSTimeInterval seconds, uint64_t enqueued, uint64_t acknowledged, double cpu, const TraceHistogram *histogram, OfflineQueue *queue, uint64_t backlogStart) {
+
+  /* ru_maxrss is in bytes on macOS */
+  printf("%-8s %7.1f s %9.0f events/s %9.0f acks/s %7.2f us cpu/event p50 %8.1f ms p99 %8.1f ms rss %7.1f MB backlog %7lu (%+.1f kB)\n",
+         label, seconds, enqueued / seconds, acknowledged / seconds, enqueued > 0 ? cpu * 1e6 / enqueued : 0.0,
+         trace_histogram_percentile(histogram, 0.50) / 1e6, trace_histogram_percentile(histogram, 0.99) / 1e6, maximumResidentSize() / 1048576.0,
+         ( unsigned long )[queue count], ( ( double )[queue size] - ( double )backlogStart ) / 1024.0);
+  fflush(stdout);
+}
+
+#pragma mark - Main
+
+int main(int argc, const char *argv[]) {
+
+#pragma unused(argc, argv)
+  @autoreleasepool {
+
+    NSUserDefaults *arguments = [NSUserDefaults standardUserDefaults];
+    NSString *server = [arguments stringForKey:@"server"] ?: @"http://127.0.0.1:8080/";
+    double rate = [arguments objectForKey:@"rate"] ? [arguments doubleForKey:@"rate"] : 500.0;
+    double duration = [arguments objectForKey:@"duration"] ? [arguments doubleForKey:@"duration"] : 300.0;
+    double interval = [arguments objectForKey:@"report"] ? [arguments doubleForKey:@"report"] : 10.0;
+    double drain = [arguments objectForKey:@"drain"] ? [arguments doubleForKey:@"drain"] : 30.0;
+    double flush = [arguments objectForKey:@"flush"] ? [arguments doubleForKey:@"flush"] : 30.0;
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"load-%d.queue", getpid()]];
+    OfflineQueue *queue = [[OfflineQueue alloc] initWithPath:path];
+    NSString *cache = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"load-%d.plist", getpid()]];
+    Statistics *statistics = [[Statistics alloc] initWithTransport:nil queue:queue];
+    [statistics configurationCachePath:cache];
+    [statistics username:@"load"];
+    [statistics password:@"load"];
+    [statistics serverFilePath:server];
+    [statistics configurationFilePath:[[NSURL URLWithString:@"configuration.json" relativeToURL:[NSURL URLWithString:server]] absoluteString]];
+    [statistics page:@"Load"];
+    [statistics networkStatus:ReachableViaWiFi];
+
+    [statistics deliveryObserver:^(NSString *message, BOOL sent) {
+
+      int64_t enqueued = integerProperty(message, @"&properties[enqueued]=");
+      if ( enqueued < 0 ) {
+
+        return;
+      }
+      uint64_t now = [Clock uptime];
+      pthread_mutex_lock(&m_mutex);
+      if ( sent ) {
+
+        /* the same histogram as the span summaries */
+        trace_histogram_add(&m_interval, now - ( uint64_t )enqueued);
+        trace_histogram_add(&m_total, now - ( uint64_t )enqueued);
+        m_acknowledged++;
+      }
+      else {
+
+        m_failed++;
+      }
+      pthread_mutex_unlock(&m_mutex);
+    }];
+
+    dispatch_queue_t generator = dispatch_queue_create("com.vxstats.statistics.load", DISPATCH_QUEUE_SERIAL);
+    uint64_t started = [Clock uptime];
+    double cpuStarted = cpuSeconds();
+    uint64_t backlogStart = [queue size];
+
+    /* events are produced in 1ms ticks, the fraction carries over */
+    __block double carry = 0.0;
+    __block uint64_t sequence = 0;
+    dispatch_source_t tick = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, generator);
+    dispatch_source_set_timer(tick, DISPATCH_TIME_NOW, NSEC_PER_MSEC, NSEC_PER_MSEC / 10);
+    dispatch_source_set_event_handler(tick, ^{
+
+      double target = ( [Clock uptime] - started ) / ( double )NSEC_PER_SEC * rate;
+      carry = target - sequence;
+      while ( carry >= 1.0 ) {
+
+        @autoreleasepool {
+
+          EventProperties *properties = [[EventProperties alloc] init];
+          [properties setInteger:( int64_t )sequence forKey:@"seq"];
+          [properties setInteger:( int64_t )[Clock uptime] forKey:@"enqueued"];
+          [statistics event:@"load" properties:properties];
+        }
+        sequence++;
+        carry -= 1.0;
+      }
+      pthread_mutex_lock(&m_mutex);
+      m_enqueued = sequence;
+      pthread_mutex_unlock(&m_mutex);
+    });
+
+    /* messages that failed wait in the queue until the next reconnect */
+    dispatch_source_t reconnect = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, generator);
+    dispatch_source_set_timer(reconnect, dispatch_time(DISPATCH_TIME_NOW, ( int64_t )( drain * NSEC_PER_SEC )), ( uint64_t )( drain * NSEC_PER_SEC ), NSEC_PER_SEC / 10);
+    dispatch_source_set_event_handler(reconnect, ^{
+
+      [statistics networkStatus:ReachableViaWiFi];
+    });
+
+    __block uint64_t lastEnqueued = 0;
+    __block uint64_t lastAcknowledged = 0;
+    __block double lastCpu = cpuStarted;
+    dispatch_source_t reporter = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(reporter, dispatch_time(DISPATCH_TIME_NOW, ( int64_t )( interval * NSEC_PER_SEC )), ( uint64_t )( interval * NSEC_PER_SEC ), NSEC_PER_SEC / 10);
+    dispatch_source_set_event_handler(reporter, ^{
+
+      pthread_mutex_lock(&m_mutex);
+      TraceHistogram histogram = m_interval;
+      memset(&m_interval, 0, sizeof(m_interval));
+      uint64_t enqueued = m_enqueued;
+      uint64_t acknowledged = m_acknowledged;
+      pthread_mutex_unlock(&m_mutex);
+      double cpu = cpuSeconds();
+      report("interval", interval, enqueued - lastEnqueued, acknowledged - lastAcknowledged, cpu - lastCpu, &histogram, queue, backlogStart);
+      lastEnqueued = enqueued;
+      lastAcknowledged = acknowledged;
+      lastCpu = cpu;
+    });
+
+    dispatch_resume(tick);
+    dispatch_resume(reconnect);
+    dispatch_resume(reporter);
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, ( int64_t )( duration * NSEC_PER_SEC )), dispatch_get_main_queue(), ^{
+
+      dispatch_source_cancel(tick);
+      dispatch_source_cancel(reconnect);
+      dispatch_source_cancel(reporter);
+      dispatch_sync(generator, ^{});
+      double seconds = ( [Clock uptime] - started ) / ( double )NSEC_PER_SEC;
+      double cpu = cpuSeconds() - cpuStarted;
+
+      pthread_mutex_lock(&m_mutex);
+      TraceHistogram histogram = m_total;
+      uint64_t enqueued = m_enqueued;
+      uint64_t acknowledged = m_acknowledged;
+      uint64_t failed = m_failed;
+      pthread_mutex_unlock(&m_mutex);
+      report("load", seconds, enqueued, acknowledged, cpu, &histogram, queue, backlogStart);
+      printf("failed   %llu uploads, %llu dropped by the queue\n", ( unsigned long long )failed, ( unsigned long long )[queue dropped]);
+
+      /* what a suspended app would leave behind */
+      [statistics flushWithDeadline:flush completion:^(NSUInteger sent, NSUInteger persisted) {
+
+        printf("flush    %lu sent, %lu persisted\n", ( unsigned long )sent, ( unsigned long )persisted);
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:cache error:nil];
+        exit(0);
+      }];
+    });
+    dispatch_main();
+  }
+}
@@ -0,0 +1,493 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/*
+ * Replays hours of usage against a simulated server in virtual time. Every
+ * event carries its sequence number as value, so the server can count
+ * delivered, duplicated and dropped messages exactly. A second run serves a
+ * configuration with sampling and a disabled action, revalidated with ETag,
+ * and checks that both take effect.
+ *
+ * Build from the project folder, Simulation/AppStub.m replaces App.m so no
+ * OpenSSL is needed:
+ *   clang -fobjc-arc -fmodules -O2 -I. Simulation/main.m Simulation/AppStub.m \
+ *     $(ls *.m | grep -v '^App\.m$') RingBuffer.c -framework SystemConfiguration -lz -o simulation
+ *
+ * Options (NSUserDefaults argument domain, e.g. -events 1000000):
+ *   -events   Number of events, default 1000000.
+ *   -rate   Events per virtual second, default 50.
+ *   -offline   Share of time without network, default 0.2.
+ *   -flap   Mean seconds between connectivity changes, default 120.
+ *   -failure   Share of requests answered with 503, default 0.01.
+ *   -latency   Server latency in seconds, default 0.08.
+ *   -seed   Random seed, default 1.
+ */
+
+/* sys header */
+#include <sys/resource.h>
+
+/* modules */
+@import Foundation;
+
+/* local header */
+#import "../Clock.h"
+#import "../OfflineQueue.h"
+#import "../Statistics+Simulation.h"
+
+#pragma mark - Random
+
+static uint64_t m_random = 1;
+
+static double uniform(void) {
+
+  /* xorshift64*, deterministic for a given seed */
+  m_random ^= m_random >> 12;
+  m_random ^= m_random << 25;
+  m_random ^= m_random >> 27;
+  return ( double )( ( m_random * 2685821657736338717ULL ) >> 11 ) / ( double )( 1ULL << 53 );
+}
+
+static double exponential(double mean) { return -mean * log(1.0 - uniform()); }
+
+#pragma mark - Scheduler
+
+typedef struct {
+
+  NSTimeInterval time;
+  uint64_t order;
+  const void *block;
+} SimulationTask;
+
+/**
+ * @~english
+ * @brief Runs blocks in virtual time order, ties in insertion order.
+ *
+ * @~german
+ * @brief Führt Blöcke in virtueller Zeitfolge aus, Gleichstände in
+ * Einfügereihenfolge.
+ */
+@interface Scheduler : NSObject {
+
+@private
+  SimulationTask *m_tasks;
+  NSUInteger m_count;
+  NSUInteger m_capacity;
+  uint64_t m_order;
+}
+- (void)after:(NSTimeInterval)delay block:(void (^)(void))block;
+- (void)runUntil:(NSTimeInterval)time;
+- (NSUInteger)count;
+@end
+
+@implementation Scheduler
+
+- (void)dealloc {
+
+  for ( NSUInteger x = 0; x < m_count; ++x ) {
+
+    CFBridgingRelease(m_tasks[x].block);
+  }
+  free(m_tasks);
+}
+
+static BOOL isEarlier(const SimulationTask *left, const SimulationTask *right) { return left->time < right->time || ( left->time == right->time && left->order < right->order ); }
+
+- (void)after:(NSTimeInterval)delay block:(void (^)(void))block {
+
+  if ( m_count == m_capacity ) {
+
+    m_capacity = m_capacity > 0 ? m_capacity * 2 : 1024;
+    m_tasks = realloc(m_tasks, m_capacity * sizeof(SimulationTask));
+  }
+
+  /* binary min-heap, sift up */
+  SimulationTask task = { [Clock now] + MAX(delay, 0.0), m_order++, CFBridgingRetain(block) };
+  NSUInteger x = m_count++;
+  while ( x > 0 && isEarlier(&task, &m_tasks[( x - 1 ) / 2]) ) {
+
+    m_tasks[x] = m_tasks[( x - 1 ) / 2];
+    x = ( x - 1 ) / 2;
+  }
+  m_tasks[x] = task;
+}
+
+- (void)runUntil:(NSTimeInterval)time {
+
+  while ( m_count > 0 && m_tasks[0].time <= time ) {
+
+    SimulationTask task = m_tasks[0];
+    SimulationTask last = m_tasks[--m_count];
+
+    /* sift down */
+    NSUInteger x = 0;
+    for ( ;; ) {
+
+      NSUInteger child = x * 2 + 1;
+      if ( child >= m_count ) {
+
+        break;
+      }
+      if ( child + 1 < m_count && isEarlier(&m_tasks[child + 1], &m_tasks[child]) ) {
+
+        child++;
+      }
+      if ( !isEarlier(&m_tasks[child], &last) ) {
+
+        break;
+      }
+      m_tasks[x] = m_tasks[child];
+      x = child;
+    }
+    if ( m_count > 0 ) {
+
+      m_tasks[x] = last;
+    }
+
+    [Clock advanceTo:task.time];
+    @autoreleasepool {
+
+      void (^block)(void) = CFBridgingRelease(task.block);
+      block();
+    }
+  }
+  [Clock advanceTo:time];
+}
+
+- (NSUInteger)count { return m_count; }
+
+@end
+
+#pragma mark - Server
+
+/**
+ * @~english
+ * @brief Simulated ingest server, answers through the scheduler.
+ *
+ * @~german
+ * @brief Simulierter Ingest-Server, antwortet über den Scheduler.
+ */
+@interface Server : NSObject <Transport> {
+
+@private
+  Scheduler *m_scheduler;
+  uint8_t *m_received;
+  NSUInteger m_events;
+}
+@property (nonatomic, assign) BOOL online;
+@property (nonatomic, assign) double failure;
+@property (nonatomic, assign) NSTimeInterval latency;
+@property (nonatomic, assign) uint64_t requests;
+@property (nonatomic, assign) uint64_t failures;
+@property (nonatomic, assign) uint64_t delivered;
+@property (nonatomic, assign) uint64_t duplicated;
+@property (nonatomic, assign) NSUInteger inFlight;
+@property (nonatomic, assign) NSUInteger peakInFlight;
+@property (nonatomic, strong) NSData *configuration;
+@property (nonatomic, assign) uint64_t configurations;
+@property (nonatomic, assign) uint64_t revalidations;
+@property (nonatomic, assign) uint64_t shakes;
+@property (nonatomic, assign) uint64_t sampled;
+- (id)initWithScheduler:(Scheduler *)scheduler events:(NSUInteger)events;
+@end
+
+@implementation Server
+
+@synthesize online;
+@synthesize failure;
+@synthesize latency;
+@synthesize requests;
+@synthesize failures;
+@synthesize delivered;
+@synthesize duplicated;
+@synthesize inFlight;
+@synthesize peakInFlight;
+@synthesize configuration;
+@synthesize configurations;
+@synthesize revalidations;
+@synthesize shakes;
+@synthesize sampled;
+
+- (id)initWithScheduler:(Scheduler *)scheduler events:(NSUInteger)events {
+
+  if ( ( self = [super init] ) ) {
+
+    m_scheduler = scheduler;
+    m_events = events;
+    m_received = calloc(events, 1);
+    online = YES;
+  }
+  return self;
+}
+
+- (void)dealloc { free(m_received); }
+
+- (void)sendRequest:(NSURLRequest *)request completionHandler:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionHandler {
+
+  requests++;
+  inFlight++;
+  peakInFlight = MAX(peakInFlight, inFlight);
+
+  /* the outcome depends on the state when the request leaves the device */
+  NSError *error = nil;
+  NSInteger status = 200;
+  NSData *data = nil;
+  NSDictionary *headers = nil;
+  if ( !online ) {
+
+    error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNotConnectedToInternet userInfo:nil];
+  }
+  else if ( [[[request URL] lastPathComponent] isEqualToString:@"configuration.json"] ) {
+
+    /* without a document the SDK keeps its defaults */
+    status = 404;
+    if ( configuration != nil ) {
+
+      NSString *etag = [NSString stringWithFormat:@"\"%lx-%lx\"", ( unsigned long )[configuration length], ( unsigned long )[configuration hash]];
+      headers = @{ @"ETag" : etag };
+      if ( [[request valueForHTTPHeaderField:@"if-none-match"] isEqualToString:etag] ) {
+
+        status = 304;
+        revalidations++;
+      }
+      else {
+
+        status = 200;
+        data = configuration;
+        configurations++;
+      }
+    }
+  }
+  else if ( uniform() < failure ) {
+
+    status = 503;
+  }
+  else {
+
+    [self receive:[request HTTPBody]];
+  }
+  if ( error != nil || status >= 500 ) {
+
+    failures++;
+  }
+
+  NSHTTPURLResponse *response = error == nil ? [[NSHTTPURLResponse alloc] initWithURL:[request URL] statusCode:status HTTPVersion:@"HTTP/1.1" headerFields:headers] : nil;
+  [m_scheduler after:( error == nil ? latency : 0.0 ) block:^{
+
+    self.inFlight--;
+    completionHandler(data, response, error);
+  }];
+}
+
+- (void)receive:(NSData *)body {
+
+  const char *bytes = [body bytes];
+  NSUInteger length = [body length];
+  if ( bytes == NULL ) {
+
+    return;
+  }
+  if ( strnstr(bytes, "&action=shake", length) != NULL ) {
+
+    shakes++;
+  }
+  if ( strnstr(bytes, "&sample=", length) != NULL ) {
+
+    sampled++;
+  }
+
+  /* events only, page views carry no sequence number */
+  const char *value = strnstr(bytes, "&value=", length);
+  if ( value == NULL ) {
+
+    return;
+  }
+  unsigned long long sequence = strtoull(value + 7, NULL, 10);
+  if ( sequence >= m_events ) {
+
+    return;
+  }
+  if ( m_received[sequence] ) {
+
+    duplicated++;
+    return;
+  }
+  m_received[sequence] = 1;
+  delivered++;
+}
+
+@end
+
+#pragma mark - Configuration
+
+static BOOL runConfiguration(Scheduler *scheduler) {
+
+  /* half of the events, no shakes and a revalidation every ten minutes */
+  NSUInteger events = 20000;
+  Server *server = [[Server alloc] initWithScheduler:scheduler events:events];
+  [server setLatency:0.05];
+  [server setConfiguration:[@"{ \"sampling\": 0.5, \"disabledActions\": [ \"shake\" ], \"maxAge\": 600 }" dataUsingEncoding:NSUTF8StringEncoding]];
+
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"simulation-configuration-%d.queue", getpid()]];
+  OfflineQueue *queue = [[OfflineQueue alloc] initWithPath:path];
+  NSString *cache = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"simulation-configuration-%d.plist", getpid()]];
+  Statistics *statistics = [[Statistics alloc] initWithTransport:server queue:queue];
+  [statistics configurationCachePath:cache];
+  [statistics username:@"simulation"];
+  [statistics password:@"simulation"];
+  [statistics serverFilePath:@"https://simulation.vxstats.com"];
+  [statistics networkStatus:ReachableViaWiFi];
+
+  /* the first message triggers the fetch, the document applies before the events start */
+  [statistics page:@"Configuration"];
+  [scheduler runUntil:[Clock now] + 1.0];
+
+  for ( NSUInteger sequence = 0; sequence < events; ) {
+
+    NSTimeInterval second = [Clock now];
+    for ( NSUInteger x = 0; x < 10 && sequence < events; ++x, ++sequence ) {
+
+      @autoreleasepool {
+
+        [statistics event:@"simulation" withValue:[NSString stringWithFormat:@"%lu", ( unsigned long )sequence]];
+      }
+    }
+    [statistics shake];
+    [scheduler runUntil:second + 1.0];
+  }
+  [scheduler runUntil:[Clock now] + 60.0];
+  [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+  [[NSFileManager defaultManager] removeItemAtPath:cache error:nil];
+
+  double share = ( double )[server delivered] / events;
+  BOOL passed = [server configurations] == 1 && [server revalidations] >= 2 && [server shakes] == 0 && share > 0.45 && share < 0.55 && [server sampled] >= [server delivered];
+  printf("configuration    %s (%llu fetched, %llu revalidated, %.1f%% sampled, %llu shakes)\n", passed ? "passed" : "FAILED", ( unsigned long long )[server configurations], ( unsigned long long )[server revalidations], share * 100.0, ( unsigned long long )[server shakes]);
+  return passed;
+}
+
+#pragma mark - Main
+
+int main(int argc, const char *argv[]) {
+
+#pragma unused(argc, argv)
+  @autoreleasepool {
+
+    NSUserDefaults *arguments = [NSUserDefaults standardUserDefaults];
+    NSUInteger events = [arguments objectForKey:@"events"] ? ( NSUInteger )[arguments integerForKey:@"events"] : 1000000;
+    double rate = [arguments objectForKey:@"rate"] ? [arguments doubleForKey:@"rate"] : 50.0;
+    double offline = [arguments objectForKey:@"offline"] ? [arguments doubleForKey:@"offline"] : 0.2;
+    double flap = [arguments objectForKey:@"flap"] ? [arguments doubleForKey:@"flap"] : 120.0;
+    m_random = [arguments objectForKey:@"seed"] ? ( uint64_t )[arguments integerForKey:@"seed"] : 1;
+    if ( m_random == 0 ) {
+
+      m_random = 1;
+    }
+
+    [Clock useVirtualTime:1600000000.0];
+    Scheduler *scheduler = [[Scheduler alloc] init];
+    Server *server = [[Server alloc] initWithScheduler:scheduler events:events];
+    [server setFailure:[arguments objectForKey:@"failure"] ? [arguments doubleForKey:@"failure"] : 0.01];
+    [server setLatency:[arguments objectForKey:@"latency"] ? [arguments doubleForKey:@"latency"] : 0.08];
+
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"simulation-%d.queue", getpid()]];
+    OfflineQueue *queue = [[OfflineQueue alloc] initWithPath:path];
+    NSString *cache = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"simulation-%d.plist", getpid()]];
+    Statistics *statistics = [[Statistics alloc] initWithTransport:server queue:queue];
+    [statistics configurationCachePath:cache];
+    [statistics username:@"simulation"];
+    [statistics password:@"simulation"];
+    [statistics serverFilePath:@"https://simulation.vxstats.com"];
+    [statistics page:@"Simulation"];
+    [statistics networkStatus:ReachableViaWiFi];
+
+    /* scripted connectivity, offline for the given share of time on average */
+    __block uint64_t flaps = 0;
+    __block BOOL generating = YES;
+    __block void (^toggle)(void) = nil;
+    void (^connectivity)(void) = ^{
+
+      if ( !generating ) {
+
+        return;
+      }
+      server.online = !server.online;
+      flaps++;
+      [statistics networkStatus:( server.online ? ReachableViaWiFi : NotReachable )];
+      double share = server.online ? 1.0 - offline : offline;
+      [scheduler after:exponential(flap * 2.0 * share) block:toggle];
+    };
+    toggle = connectivity;
+    if ( offline > 0.0 ) {
+
+      [scheduler after:exponential(flap * 2.0 * ( 1.0 - offline )) block:toggle];
+    }
+
+    /* events in batches of one virtual second keep the heap small */
+    clock_t started = clock();
+    NSTimeInterval start = [Clock now];
+    NSUInteger sequence = 0;
+    uint64_t peakQueue = 0;
+    while ( sequence < events ) {
+
+      NSTimeInterval second = [Clock now];
+      NSUInteger count = MAX(( NSUInteger )1, ( NSUInteger )rate);
+      for ( NSUInteger x = 0; x < count && sequence < events; ++x, ++sequence ) {
+
+        [scheduler runUntil:second + ( double )x / count];
+        @autoreleasepool {
+
+          [statistics event:@"simulation" withValue:[NSString stringWithFormat:@"%lu", ( unsigned long )sequence]];
+        }
+      }
+      [scheduler runUntil:second + 1.0];
+      peakQueue = MAX(peakQueue, [queue size]);
+    }
+
+    /* back online until the backlog is gone or stops shrinking */
+    generating = NO;
+    toggle = nil;
+    server.online = YES;
+    NSUInteger stalled = 0;
+    while ( stalled < 10 ) {
+
+      NSUInteger backlog = [queue count];
+      [statistics networkStatus:ReachableViaWiFi];
+      [scheduler runUntil:[Clock now] + 60.0];
+      stalled = [queue count] >= backlog && [server inFlight] == 0 ? stalled + 1 : 0;
+      if ( [queue count] == 0 && [server inFlight] == 0 ) {
+
+        break;
+      }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double cpu = ( double )( clock() - started ) / CLOCKS_PER_SEC;
+    uint64_t delivered = [server delivered];
+    printf("virtual time     %.1f h in %.2f s cpu\n", ( [Clock now] - start ) / 3600.0, cpu);
+    printf("events           %lu\n", ( unsigned long )events);
+    printf("delivered        %llu\n", ( unsigned long long )delivered);
+    printf("duplicated       %llu\n", ( unsigned long long )[server duplicated]);
+    printf("dropped          %llu (queue overflow %llu, still queued %lu)\n", ( unsigned long long )( events - delivered ), ( unsigned long long )[queue dropped], ( unsigned long )[queue count]);
+    printf("requests         %llu (%llu failed, peak %lu in flight)\n", ( unsigned long long )[server requests], ( unsigned long long )[server failures], ( unsigned long )[server peakInFlight]);
+    printf("flaps            %llu\n", ( unsigned long long )flaps);
+    printf("peak memory      %.1f MB\n", usage.ru_maxrss / 1048576.0);
+    printf("peak disk        %.1f kB\n", peakQueue / 1024.0);
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:cache error:nil];
+    BOOL configured = runConfiguration(scheduler);
+    return delivered + [queue dropped] >= events && configured ? 0 : 1;
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "Reachability.h"
+#import "Statistics.h"
+#import "Transport.h"
+
+/* local class */
+@class OfflineQueue;
+
+/**
+ * @~english
+ * @brief Injection points for simulations and load tests. Not meant for apps.
+ *
+ * @~german
+ * @brief Einstiegspunkte für Simulationen und Lasttests. Nicht für Anwendungen
+ * gedacht.
+ */
+@interface Statistics (Simulation)
+
+/**
+ * @~english
+ * @brief Creates an instance without system reachability. The cached
+ * configuration of the app is loaded once server paths are set, unless
+ * configurationCachePath: was called before.
+ * @param transport   Carries all requests, nil for NSURLSession.
+ * @param queue   The offline queue.
+ * @return The instance for statistics.
+ *
+ * @~german
+ * @brief Erstellt eine Instanz ohne Systemerreichbarkeit. Die
+ * zwischengespeicherte Konfiguration der Anwendung wird geladen, sobald
+ * Serverpfade gesetzt sind, außer configurationCachePath: wurde vorher
+ * aufgerufen.
+ * @param transport   Überträgt alle Anfragen, nil für NSURLSession.
+ * @param queue   Die Offline-Queue.
+ * @return Die Instanz für Statistiken.
+ */
+- (id)initWithTransport:(id<Transport>)transport queue:(OfflineQueue *)queue;
+
+/**
+ * @~english
+ * @brief Replaces the configuration cache, so a test neither reads nor
+ * overwrites the document cached for the app. Loads the file right away.
+ * @param configurationCachePath   A temporary file.
+ *
+ * @~german
+ * @brief Ersetzt den Konfigurationscache, damit ein Test das für die
+ * Anwendung zwischengespeicherte Dokument weder liest noch überschreibt. Lädt
+ * die Datei sofort.
+ * @param configurationCachePath   Eine temporäre Datei.
+ */
+- (void)configurationCachePath:(NSString *)configurationCachePath;
+
+/**
+ * @~english
+ * @brief Applies a scripted network state like a reachability change.
+ * @param status   The network state.
+ *
+ * @~german
+ * @brief Übernimmt einen vorgegebenen Netzwerkstatus wie eine Änderung der
+ * Erreichbarkeit.
+ * @param status   Der Netzwerkstatus.
+ */
+- (void)networkStatus:(NetworkStatus)status;
+
+/**
+ * @~english
+ * @brief Observes the outcome of every upload, e.g. to measure the time from
+ * enqueue to acknowledgement.
+ * @param observer   Called with the message and whether the server accepted
+ * it, on the thread of the response; nil removes the observer.
+ *
+ * @~german
+ * @brief Beobachtet das Ergebnis jeder Übertragung, z.B. um die Zeit vom
+ * Einreihen bis zur Bestätigung zu messen.
+ * @param observer   Wird mit der Nachricht aufgerufen und ob der Server sie
+ * angenommen hat, im Thread der Antwort; nil entfernt den Beobachter.
+ */
+- (void)deliveryObserver:(void (^)(NSString *message, BOOL sent))observer;
+
+@end
@@ -16,8 +16,16 @@
 /* modules */
 @import Foundation;
 
+/* local header */
+#import "EventProperties.h"
+
 /* local class */
+@class Endpoint;
+@class NameTable;
+@class OfflineQueue;
 @class Reachability;
+@class Trace;
+@protocol Transport;
 
 /**
  * @~english
@@ -44,8 +52,8 @@
  *
  * @b Offline entries:
  * @n Statistic entries that have not been sent successfully are filed in a
- * queue of local settings and sent as soon as an 
- * internet connection is established. Estimations assume that there is
+ * queue file shared with app extensions via the app group and sent by the app
+ * as soon as an internet connection is established. Estimations assume that there is
  * less than 5% not received statistic data.
  *
  * @b Data privacy:
@@ -97,9 +105,9 @@
  * entsprechend asynchron oder synchron abgearbeitet.
  *
  * @b Offline-Einträge:
- * @n Nicht erfolgreich versendete Statistikeinträge werden in einer Queue der
- * lokalen Einstellungen abgelegt und versendet, sobald wieder eine
- * Internetverbindung besteht. Schätzungen gehen von weniger als 5% nicht
+ * @n Nicht erfolgreich versendete Statistikeinträge werden in einer über die
+ * App-Group mit Erweiterungen geteilten Queue-Datei abgelegt und von der
+ * Anwendung versendet, sobald wieder eine Internetverbindung besteht. Schätzungen gehen von weniger als 5% nicht
  * empfangener Statistikdaten aus.
  *
  * @b Datenschutz:
@@ -149,6 +157,24 @@
    */
   NSString *m_serverFilePath;
 
+  /**
+   * @~english
+   * @brief Paths to statistics servers in order of preference.
+   *
+   * @~german
+   * @brief Pfade zu Statistikservern in der Reihenfolge ihrer Priorität.
+   */
+  NSArray<NSString *> *m_serverFilePaths;
+
+  /**
+   * @~english
+   * @brief Statistics servers with their health, selected per request.
+   *
+   * @~german
+   * @brief Statistikserver mit ihrem Zustand, pro Anfrage ausgewählt.
+   */
+  NSArray<Endpoint *> *m_endpoints;
+
   /**
    * @~english
    * @brief Username for authorization.
@@ -167,6 +193,26 @@
    */
   NSString *m_password;
 
+  /**
+   * @~english
+   * @brief Authorization header built once from username and password, sent
+   * with every request to avoid a challenge round-trip.
+   *
+   * @~german
+   * @brief Einmal aus Benutzername und Passwort gebildeter Authorization-Header,
+   * wird mit jeder Anfrage gesendet, um eine Challenge-Runde zu vermeiden.
+   */
+  NSString *m_authorization;
+
+  /**
+   * @~english
+   * @brief Session shared by all requests, keeps connections alive.
+   *
+   * @~german
+   * @brief Von allen Anfragen geteilte Session, hält Verbindungen offen.
+   */
+  NSURLSession *m_session;
+
   /**
    * @~english
    * @brief The last used page is buffered in order to use the actions and
@@ -197,6 +243,101 @@
    * ermitteln oder ausstehende Daten zu senden.
    */
   Reachability *m_reachability;
+
+  /**
+   * @~english
+   * @brief Interned page and action names with their escaped form.
+   *
+   * @~german
+   * @brief Aufgenommene Seiten- und Aktionsnamen mit ihrer maskierten Form.
+   */
+  NameTable *m_names;
+
+  /**
+   * @~english
+   * @brief Latency histograms of measured spans.
+   *
+   * @~german
+   * @brief Latenzhistogramme der gemessenen Spans.
+   */
+  Trace *m_trace;
+
+  /**
+   * @~english
+   * @brief Path to the configuration document, relative to the statistics
+   * server if nil.
+   *
+   * @~german
+   * @brief Pfad zum Konfigurationsdokument, relativ zum Statistikserver, wenn
+   * nil.
+   */
+  NSString *m_configurationFilePath;
+
+  /**
+   * @~english
+   * @brief Injected path of the configuration cache, derived from the bundle
+   * identifier and the configuration document if nil.
+   *
+   * @~german
+   * @brief Vorgegebener Pfad des Konfigurationscaches, aus der Bundle-ID und
+   * dem Konfigurationsdokument abgeleitet, wenn nil.
+   */
+  NSString *m_configurationCachePath;
+
+  /**
+   * @~english
+   * @brief Entity tag of the cached configuration document.
+   *
+   * @~german
+   * @brief Entity-Tag des zwischengespeicherten Konfigurationsdokuments.
+   */
+  NSString *m_configurationETag;
+
+  /**
+   * @~english
+   * @brief Time of the last successful validation of the configuration.
+   *
+   * @~german
+   * @brief Zeitpunkt der letzten erfolgreichen Prüfung der Konfiguration.
+   */
+  NSTimeInterval m_configurationValidated;
+
+  /**
+   * @~english
+   * @brief True, while the configuration is requested.
+   *
+   * @~german
+   * @brief Wahr, während die Konfiguration angefragt wird.
+   */
+  BOOL m_configurationLoading;
+
+  /**
+   * @~english
+   * @brief Carries all requests, nil for NSURLSession.
+   *
+   * @~german
+   * @brief Überträgt alle Anfragen, nil für NSURLSession.
+   */
+  id<Transport> m_transport;
+
+  /**
+   * @~english
+   * @brief Queue of messages that could not be sent.
+   *
+   * @~german
+   * @brief Queue der Nachrichten, die nicht gesendet werden konnten.
+   */
+  OfflineQueue *m_queue;
+
+  /**
+   * @~english
+   * @brief Called with the outcome of every upload, nil without load test.
+   *
+   * @~german
+   * @brief Wird mit dem Ergebnis jeder Übertragung aufgerufen, nil ohne
+   * Lasttest.
+   */
+  void (^m_deliveryObserver)(NSString *message, BOOL sent);
 }
 
 /**
@@ -243,11 +384,74 @@
 
 /**
  * @~english
- * @brief Defines the username to the statistics server.
+ * @brief Defines several paths to statistics servers. Each message is sent to
+ * the healthy server with the best latency and error rate; a failed message
+ * is sent to the next best server right away and failed servers are probed
+ * again after a growing delay.
+ * @param serverFilePaths   The paths to the statistics servers, the first one
+ * is preferred until latencies are known.
+ *
+ * @~german
+ * @brief Definiert mehrere Pfade zu Statistikservern. Jede Nachricht wird an
+ * den erreichbaren Server mit der besten Latenz und Fehlerrate gesendet; eine
+ * fehlgeschlagene Nachricht geht sofort an den nächstbesten Server und
+ * ausgefallene Server werden nach einer wachsenden Wartezeit erneut geprüft.
+ * @param serverFilePaths   Die Pfade zu den Statistikservern, der erste wird
+ * bevorzugt, bis Latenzen bekannt sind.
+ *
+ * @~
+ * @code
+ * [[Statistics instance] serverFilePaths:@[ @"https://eu.vxstats.com", @"https://us.vxstats.com" ]];
+ * @endcode
+ */
+- (void)serverFilePaths:(NSArray<NSString *> *)serverFilePaths;
+
+/**
+ * @~english
+ * @brief Returns the metrics of all statistics servers.
+ * @return One dictionary per server, see Endpoint#metrics.
+ *
+ * @~german
+ * @brief Gibt die Kennzahlen aller Statistikserver zurück.
+ * @return Ein Dictionary pro Server, siehe Endpoint#metrics.
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)endpointMetrics;
+
+/**
+ * @~english
+ * @brief Defines the path to the configuration document of the statistics
+ * server. By default 'configuration.json' relative to the path of the
+ * statistics server is used. The document is cached and revalidated with
+ * If-None-Match after its 'maxAge'.
+ * @param configurationFilePath   The path to the configuration document.
+ *
+ * @~german
+ * @brief Definiert den Pfad zum Konfigurationsdokument des Statistikservers.
+ * Standardmäßig wird 'configuration.json' relativ zum Pfad des
+ * Statistikservers verwendet. Das Dokument wird zwischengespeichert und nach
+ * seinem 'maxAge' mit If-None-Match erneut geprüft.
+ * @param configurationFilePath   Der Pfad zum Konfigurationsdokument.
+ *
+ * @~
+ * @code
+ * [[Statistics instance] configurationFilePath:@"http://localhost:8080/configuration.json"];
+ * @endcode
+ *
+ * @see Configuration
+ */
+- (void)configurationFilePath:(NSString *)configurationFilePath;
+
+/**
+ * @~english
+ * @brief Defines the username to the statistics server. Over HTTPS the
+ * credentials are sent with every request, over plain HTTP only when the
+ * server asks for them.
  * @param username   The username to the statistics server.
  *
  * @~german
- * @brief Definiert den Benutzernamen zum Statistikserver.
+ * @brief Definiert den Benutzernamen zum Statistikserver. Über HTTPS werden
+ * die Zugangsdaten mit jeder Anfrage gesendet, über einfaches HTTP nur, wenn
+ * der Server danach fragt.
  * @param username   Der Benutzername zum Statistikserver.
  *
  * @~
@@ -442,6 +646,30 @@
  */
 - (void)event:(NSString *)eventName withValue:(NSString *)value;
 
+/**
+ * @~english
+ * @brief Event with typed properties instead of a single text value. Numbers
+ * keep their full precision and are never formatted as NSString.
+ * @param eventName   The event.
+ * @param properties   Up to EVENT_PROPERTIES_MAX named values.
+ *
+ * @~german
+ * @brief Event mit typisierten Eigenschaften statt eines einzelnen Textwerts.
+ * Zahlen behalten ihre volle Genauigkeit und werden nie als NSString
+ * formatiert.
+ * @param eventName   Das Event.
+ * @param properties   Bis zu EVENT_PROPERTIES_MAX benannte Werte.
+ *
+ * @~
+ * @code
+ * EventProperties *properties = [[EventProperties alloc] init];
+ * [properties setInteger:[items count] forKey:@"items"];
+ * [properties setDouble:duration forKey:@"duration"];
+ * [[Statistics instance] event:@"download" properties:properties];
+ * @endcode
+ */
+- (void)event:(NSString *)eventName properties:(EventProperties *)properties;
+
 /**
  * @~english
  * @brief To capture ads - correspondingly the shown ad.
@@ -584,6 +812,119 @@
  */
 - (void)touch:(NSString *)action;
 
+/**
+ * @~english
+ * @brief Starts a span, measured with a monotonic high-resolution clock.
+ * @return The start of the span, to be passed to Statistics#endSpan:start:.
+ *
+ * @~german
+ * @brief Startet einen Span, gemessen mit einer monotonen hochauflösenden Uhr.
+ * @return Der Start des Spans, zur Übergabe an Statistics#endSpan:start:.
+ *
+ * @~
+ * @code
+ * uint64_t start = [[Statistics instance] beginSpan];
+ * [self loadContent];
+ * [[Statistics instance] endSpan:@"load" start:start];
+ * @endcode
+ */
+- (uint64_t)beginSpan;
+
+/**
+ * @~english
+ * @brief Ends a span and adds its duration to the histogram of name. Spans are
+ * aggregated on the device and transferred as summary records with action
+ * 'span'. Summaries carry an empty page, since they cover spans of several
+ * pages.
+ * @param name   The name of the span.
+ * @param start   The value returned by Statistics#beginSpan.
+ * @note Limited to 255 characters.
+ *
+ * @~german
+ * @brief Beendet einen Span und fügt seine Dauer dem Histogramm von name hinzu.
+ * Spans werden auf dem Gerät zusammengefasst und als Zusammenfassung mit der
+ * Aktion 'span' übertragen. Zusammenfassungen haben eine leere Seite, da sie
+ * Spans mehrerer Seiten umfassen.
+ * @param name   Der Name des Spans.
+ * @param start   Der Rückgabewert von Statistics#beginSpan.
+ * @note Auf 255 Zeichen begrenzt.
+ */
+- (void)endSpan:(NSString *)name start:(uint64_t)start;
+
+/**
+ * @~english
+ * @brief Measures the execution of block as span with the given name.
+ * @param name   The name of the span.
+ * @param block   The measured code.
+ *
+ * @~german
+ * @brief Misst die Ausführung von block als Span mit dem angegebenen Namen.
+ * @param name   Der Name des Spans.
+ * @param block   Der gemessene Code.
+ *
+ * @~
+ * @code
+ * [[Statistics instance] span:@"layout" block:^{
+ *   [self layoutContent];
+ * }];
+ * @endcode
+ */
+- (void)span:(NSString *)name block:(void (^)(void))block;
+
+/**
+ * @~english
+ * @brief Transfers the summaries of all spans measured so far.
+ *
+ * @~german
+ * @brief Überträgt die Zusammenfassungen aller bisher gemessenen Spans.
+ */
+- (void)flushSpans;
+
+/**
+ * @~english
+ * @brief Drains the statistics before the app is suspended or an extension
+ * exits. Span summaries are written to the offline queue right away, then
+ * queued messages are sent in queue order, events before the new span
+ * summaries. Single failed uploads go back to the queue and the flush goes
+ * on; it stops early after eight failures in a row or when no server is
+ * available. Requests of the flush still running at the deadline are
+ * cancelled and their messages stay queued for the next start. Uploads
+ * started before the flush, e.g. of events just recorded, and requests for
+ * the configuration are neither counted nor cancelled; they write their
+ * message back to the queue if they fail before the process is suspended.
+ * @param deadline   Seconds available for sending.
+ * @param completion   Called once on the main queue with the number of
+ * messages sent by the flush and the number of messages left in the offline
+ * queue, including messages kept in the settings.
+ *
+ * @~german
+ * @brief Leert die Statistiken, bevor die Anwendung angehalten wird oder eine
+ * Erweiterung endet. Span-Zusammenfassungen werden sofort in die Offline-Queue
+ * geschrieben, danach werden die Nachrichten in Queue-Reihenfolge gesendet,
+ * Events vor den neuen Span-Zusammenfassungen. Einzelne fehlgeschlagene
+ * Übertragungen gehen zurück in die Queue und das Leeren läuft weiter; es
+ * endet vorzeitig nach acht Fehlern in Folge oder wenn kein Server erreichbar
+ * ist. Bei Ablauf noch laufende Anfragen des Leerens werden abgebrochen und
+ * ihre Nachrichten bleiben für den nächsten Start in der Queue.
+ * Übertragungen, die vor dem Leeren begonnen wurden, z.B. gerade erfasster
+ * Events, und Anfragen für die Konfiguration werden weder gezählt noch
+ * abgebrochen; schlagen sie fehl, bevor der Prozess angehalten wird, schreiben
+ * sie ihre Nachricht zurück in die Queue.
+ * @param deadline   Verfügbare Sekunden zum Senden.
+ * @param completion   Wird einmal auf der Main-Queue mit der Anzahl der vom
+ * Leeren gesendeten und der in der Offline-Queue verbliebenen Nachrichten
+ * aufgerufen, einschließlich der in den Einstellungen abgelegten.
+ *
+ * @~
+ * @code
+ * UIBackgroundTaskIdentifier task = [application beginBackgroundTaskWithExpirationHandler:nil];
+ * [[Statistics instance] flushWithDeadline:5.0 completion:^(NSUInteger sent, NSUInteger persisted) {
+ *   [application endBackgroundTask:task];
+ * }];
+ * @endcode
+ */
+- (void)flushWithDeadline:(NSTimeInterval)deadline completion:(void (^)(NSUInteger sent, NSUInteger persisted))completion;
+
 /**
  * @~english
  * @brief The instance for statistics.
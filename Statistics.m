@@ -13,11 +13,24 @@
  * Zuwiderhandlungen werden strafrechtlich verfolgt.
  */
 
+/* c header */
+#include <stdatomic.h>
+#include <zlib.h>
+
 /* local header */
 #import "App.h"
+#import "Clock.h"
+#import "Configuration.h"
 #import "Device.h"
+#import "Diagnostics.h"
+#import "Endpoint.h"
+#import "EventProperties.h"
+#import "NameTable.h"
+#import "OfflineQueue.h"
 #import "Reachability.h"
+#import "Statistics+Simulation.h"
 #import "Statistics.h"
+#import "Trace.h"
 
 /* modules */
 #if TARGET_OS_MAC && !(TARGET_OS_IPHONE)
@@ -30,12 +43,56 @@
 
 static Statistics *m_statisticInstance;
 
+/* requests in flight while flushing */
+#define FLUSH_CONCURRENCY 4
+
+/* failed uploads in a row before a flush gives up */
+#define FLUSH_FAILURE_LIMIT 8
+
+/* kept out of the public header, C11 atomics do not compile as Objective-C++ */
+@interface Statistics () {
+
+@private
+  /**
+   * @~english
+   * @brief Current configuration of this instance, replaced as a whole and
+   * read without locks.
+   *
+   * @~german
+   * @brief Aktuelle Konfiguration dieser Instanz, als Ganzes ersetzt und ohne
+   * Sperren gelesen.
+   */
+  _Atomic(const void *) m_configuration;
+}
+@end
+
 @interface Statistics (PrivateMethods)
 - (NSString *)coreMessage;
+- (NSString *)coreMessageForPage:(NSString *)pageName;
+- (void)escapedEvent:(NSString *)eventName withValue:(NSString *)value;
+- (void)escapedEvent:(NSString *)eventName withValue:(NSString *)value properties:(EventProperties *)properties;
+- (NSArray<NSString *> *)spanMessages;
 - (void)sendMessage:(NSString *)message;
+- (void)sendMessage:(NSString *)message started:(void (^)(NSURLSessionTask *task))started completion:(void (^)(BOOL sent))completion;
+- (void)sendMessage:(NSString *)message tried:(NSArray<Endpoint *> *)tried started:(void (^)(NSURLSessionTask *task))started completion:(void (^)(BOOL sent))completion;
 - (void)addOutstandingMessage:(NSString *)message;
+- (NSUInteger)outstandingMessageCount;
+- (NSArray<NSString *> *)takeOutstandingMessages:(NSUInteger)limit;
 - (void)sendOutstandingMessages;
 - (void)updateInterfaceWithReachability:(Reachability *)reachability;
+- (Configuration *)configuration;
+- (void)applyConfiguration:(Configuration *)configuration;
+- (NSURL *)configurationURL;
+- (NSString *)configurationCachePath;
+- (void)loadCachedConfiguration;
+- (void)updateConfiguration;
+- (void)updateEndpoints;
+- (NSArray<Endpoint *> *)endpoints;
+- (Endpoint *)nextEndpoint;
+- (NSURLSessionTask *)sendRequest:(NSURLRequest *)request completionHandler:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionHandler;
+- (void)updateAuthorization;
+- (NSString *)authorization;
+- (void)authorize:(NSMutableURLRequest *)request;
 @end
 
 @implementation Statistics
@@ -46,10 +103,8 @@ static Statistics *m_statisticInstance;
 
 - (id)init {
 
-  m_status = @"Offline";
-  m_serverFilePath = nil;
-  lastPageName = nil;
-  m_lastMessage = nil;
+  self = [self initWithTransport:nil queue:[OfflineQueue sharedQueue]];
+  [self loadCachedConfiguration];
 
   [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(reachabilityChanged:) name:kReachabilityChangedNotification object:nil];
 
@@ -60,58 +115,185 @@ static Statistics *m_statisticInstance;
   return self;
 }
 
+- (id)initWithTransport:(id<Transport>)transport queue:(OfflineQueue *)queue {
+
+  if ( ( self = [super init] ) ) {
+
+    m_status = @"Offline";
+    m_serverFilePath = nil;
+    m_serverFilePaths = nil;
+    m_endpoints = @[];
+    lastPageName = nil;
+    m_lastMessage = nil;
+    m_names = [[NameTable alloc] initWithCapacity:256];
+    m_trace = [[Trace alloc] init];
+    m_configurationFilePath = nil;
+    m_configurationCachePath = nil;
+    m_configurationETag = nil;
+    m_configurationValidated = 0;
+    m_configurationLoading = NO;
+    m_authorization = nil;
+    m_transport = transport;
+    m_queue = queue;
+    m_deliveryObserver = nil;
+    if ( m_transport == nil ) {
+
+      m_session = [NSURLSession sessionWithConfiguration:[NSURLSessionConfiguration defaultSessionConfiguration] delegate:self delegateQueue:nil];
+    }
+    [self applyConfiguration:[self configuration]];
+  }
+  return self;
+}
+
+- (void)dealloc {
+
+  const void *configuration = atomic_exchange_explicit(&m_configuration, NULL, memory_order_acq_rel);
+  if ( configuration != NULL ) {
+
+    CFRelease(configuration);
+  }
+}
+
 - (void)manualUpdate { [self updateInterfaceWithReachability:m_reachability]; }
-- (void)serverFilePath:(NSString *)serverFilePath { m_serverFilePath = serverFilePath; }
-- (void)username:(NSString *)username { m_username = username; }
-- (void)password:(NSString *)password { m_password = password; }
+- (void)serverFilePath:(NSString *)serverFilePath { [self serverFilePaths:( [serverFilePath length] > 0 ? @[ serverFilePath ] : nil )]; }
+
+- (void)serverFilePaths:(NSArray<NSString *> *)serverFilePaths {
+
+  NSString *previous = [self configurationCachePath];
+  m_serverFilePath = [serverFilePaths firstObject];
+  m_serverFilePaths = [serverFilePaths copy];
+  NSString *path = [self configurationCachePath];
+  if ( path != nil && ![path isEqualToString:previous] ) {
+
+    /* another server has its own cached document, applying it updates the endpoints */
+    [self loadCachedConfiguration];
+  }
+  else {
+
+    [self updateEndpoints];
+  }
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)endpointMetrics {
+
+  NSArray<Endpoint *> *endpoints = [self endpoints];
+  NSMutableArray *metrics = [NSMutableArray arrayWithCapacity:[endpoints count]];
+  for ( Endpoint *endpoint in endpoints ) {
+
+    [metrics addObject:[endpoint metrics]];
+  }
+  return metrics;
+}
+- (void)configurationFilePath:(NSString *)configurationFilePath {
+
+  NSString *previous = [self configurationCachePath];
+  m_configurationFilePath = configurationFilePath;
+  NSString *path = [self configurationCachePath];
+  if ( path != nil && ![path isEqualToString:previous] ) {
+
+    [self loadCachedConfiguration];
+  }
+}
+
+- (void)configurationCachePath:(NSString *)configurationCachePath {
+
+  m_configurationCachePath = [configurationCachePath copy];
+  [self loadCachedConfiguration];
+}
+
+- (void)username:(NSString *)username {
+
+  @synchronized ( self ) {
+
+    m_username = username;
+  }
+  [self updateAuthorization];
+}
+
+- (void)password:(NSString *)password {
+
+  @synchronized ( self ) {
+
+    m_password = password;
+  }
+  [self updateAuthorization];
+}
 
 - (void)page:(NSString *)pageName {
 
   if ( [pageName length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - page with empty 'pageName'", __PRETTY_FUNCTION__, __LINE__);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - page with empty 'pageName'");
     return;
   }
   else if ( [pageName length] > 255 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'pageName': '%@' is larger than 255 signs", __PRETTY_FUNCTION__, __LINE__, pageName);
-    pageName = [pageName substringToIndex:255];
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'pageName': '%@' is larger than 255 signs", pageName);
   }
 
-  pageName = [pageName stringByReplacingOccurrencesOfString:@"&" withString:@"%26"];
-  pageName = [pageName stringByReplacingOccurrencesOfString:@"'" withString:@"%2F'"];
-  pageName = [pageName stringByReplacingOccurrencesOfString:@"|" withString:@"%7C"];
+  /* interned names are truncated and escaped once and shared afterwards */
+  lastPageName = [m_names escapedName:pageName];
 
-  NSString *tmpString = [pageName copy];
-  lastPageName = tmpString;
-
-  [self event:nil withValue:nil];
+  [self escapedEvent:nil withValue:nil];
 }
 
 - (void)event:(NSString *)eventName withValue:(NSString *)value {
 
   if ( [lastPageName length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'event': '%@' with empty 'pageName'", __PRETTY_FUNCTION__, __LINE__, eventName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'event': '%@' with empty 'pageName'", eventName);
+  }
+
+  /* event names are a small vocabulary, values are free text */
+  [self escapedEvent:[m_names escapedName:eventName] withValue:[NameTable escape:value]];
+}
+
+- (void)event:(NSString *)eventName properties:(EventProperties *)properties {
+
+  if ( [lastPageName length] == 0 ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'event': '%@' with empty 'pageName'", eventName);
   }
+  [self escapedEvent:[m_names escapedName:eventName] withValue:nil properties:properties];
+}
+
+- (void)escapedEvent:(NSString *)eventName withValue:(NSString *)value { [self escapedEvent:eventName withValue:value properties:nil]; }
+
+- (void)escapedEvent:(NSString *)eventName withValue:(NSString *)value properties:(EventProperties *)properties {
 
-  eventName = [eventName stringByReplacingOccurrencesOfString:@"&" withString:@"%26"];
-  eventName = [eventName stringByReplacingOccurrencesOfString:@"'" withString:@"%2F'"];
-  eventName = [eventName stringByReplacingOccurrencesOfString:@"|" withString:@"%7C"];
+  Configuration *configuration = [self configuration];
+  if ( ![configuration allowsAction:eventName] ) {
 
-  value = [value stringByReplacingOccurrencesOfString:@"&" withString:@"%26"];
-  value = [value stringByReplacingOccurrencesOfString:@"'" withString:@"%2F'"];
-  value = [value stringByReplacingOccurrencesOfString:@"|" withString:@"%7C"];
+    return;
+  }
 
   NSMutableString *message = [[NSMutableString alloc] init];
   [message appendString:[self coreMessage]];
+  if ( [configuration sampling] < 1.0 ) {
+
+    /* lets the server scale sampled events up again */
+    [message appendFormat:@"&sample=%.6g", [configuration sampling]];
+  }
   if ( [eventName length] > 0 ) {
 
-    [message appendString:[NSString stringWithFormat:@"&action=%@", eventName]];
+    [message appendString:@"&action="];
+    [message appendString:eventName];
   }
   if ( [value length] > 0 ) {
 
-    [message appendString:[NSString stringWithFormat:@"&value=%@", value]];
+    [message appendString:@"&value="];
+    [message appendString:value];
+  }
+  NSUInteger length = 0;
+  const char *bytes = [properties bytes:&length];
+  if ( length > 0 ) {
+
+    /* a wrapper around the encoded bytes, appending copies them once into the message */
+    NSString *encoded = [[NSString alloc] initWithBytesNoCopy:( void * )bytes length:length encoding:NSUTF8StringEncoding freeWhenDone:NO];
+    if ( encoded != nil ) {
+
+      [message appendString:encoded];
+    }
   }
   [self sendMessage:message];
 }
@@ -120,11 +302,11 @@ static Statistics *m_statisticInstance;
 
   if ( [campaign length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'ads' with empty 'campaign' name, pageName: %@", __PRETTY_FUNCTION__, __LINE__, lastPageName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'ads' with empty 'campaign' name, pageName: %@", lastPageName);
   }
   else if ( [campaign length] > 255 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'campaign': '%@' is larger than 255 signs", __PRETTY_FUNCTION__, __LINE__, campaign);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'campaign': '%@' is larger than 255 signs", campaign);
     campaign = [campaign substringToIndex:255];
   }
   [self event:@"ads" withValue:campaign];
@@ -134,20 +316,24 @@ static Statistics *m_statisticInstance;
 
   if ( latitude == 0.0 || longitude == 0.0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'move' with empty 'latitude' or 'longitude'", __PRETTY_FUNCTION__, __LINE__);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'move' with empty 'latitude' or 'longitude'");
   }
-  [self event:@"move" withValue:[NSString stringWithFormat:@"%f,%f", latitude, longitude]];
+
+  /* nine significant digits keep every float exact, formatted on the stack instead of through an NSString format */
+  char value[2 * 16 + 2];
+  int length = snprintf(value, sizeof(value), "%.9g,%.9g", latitude, longitude);
+  [self escapedEvent:[m_names escapedName:@"move"] withValue:[[NSString alloc] initWithBytes:value length:( NSUInteger )length encoding:NSASCIIStringEncoding]];
 }
 
 - (void)open:(NSString *)urlOrName {
 
   if ( [urlOrName length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'open' with empty 'urlOrName', pageName: '%@'", __PRETTY_FUNCTION__, __LINE__, lastPageName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'open' with empty 'urlOrName', pageName: '%@'", lastPageName);
   }
   else if ( [urlOrName length] > 255 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'urlOrName': '%@' is larger than 255 signs", __PRETTY_FUNCTION__, __LINE__, urlOrName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'urlOrName': '%@' is larger than 255 signs", urlOrName);
     urlOrName = [urlOrName substringToIndex:255];
   }
   [self event:@"open" withValue:urlOrName];
@@ -157,11 +343,11 @@ static Statistics *m_statisticInstance;
 
   if ( [urlOrName length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'play' with empty 'urlOrName', pageName: '%@'", __PRETTY_FUNCTION__, __LINE__, lastPageName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'play' with empty 'urlOrName', pageName: '%@'", lastPageName);
   }
   else if ( [urlOrName length] > 255 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'urlOrName': '%@' is larger than 255 signs", __PRETTY_FUNCTION__, __LINE__, urlOrName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'urlOrName': '%@' is larger than 255 signs", urlOrName);
     urlOrName = [urlOrName substringToIndex:255];
   }
   [self event:@"play" withValue:urlOrName];
@@ -171,11 +357,11 @@ static Statistics *m_statisticInstance;
 
   if ( [text length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'search' with empty 'text', pageName: '%@'", __PRETTY_FUNCTION__, __LINE__, lastPageName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'search' with empty 'text', pageName: '%@'", lastPageName);
   }
   else if ( [text length] > 255 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'text': '%@' is larger than 255 signs", __PRETTY_FUNCTION__, __LINE__, text);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'text': '%@' is larger than 255 signs", text);
     text = [text substringToIndex:255];
   }
   [self event:@"search" withValue:text];
@@ -187,17 +373,197 @@ static Statistics *m_statisticInstance;
 
   if ( [action length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'touch' with empty 'action', pageName: '%@'", __PRETTY_FUNCTION__, __LINE__, lastPageName);
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'touch' with empty 'action', pageName: '%@'", lastPageName);
   }
   else if ( [action length] > 255 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'action': '%@' is larger than 255 signs", __PRETTY_FUNCTION__, __LINE__, action);
-    action = [action substringToIndex:255];
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'action': '%@' is larger than 255 signs", action);
+  }
+  [self escapedEvent:[m_names escapedName:@"touch"] withValue:[m_names escapedName:action]];
+}
+
+- (uint64_t)beginSpan { return [Clock uptime]; }
+
+- (void)endSpan:(NSString *)name start:(uint64_t)start {
+
+  uint64_t end = [Clock uptime];
+  if ( [name length] == 0 ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'endSpan' with empty 'name'");
+    return;
+  }
+  if ( [m_trace record:( end > start ? end - start : 0 ) forName:[m_names escapedName:name]] ) {
+
+    /* building the summaries is not part of the measured code path */
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+
+      [self flushSpans];
+    });
   }
-  [self event:@"touch" withValue:action];
 }
 
-- (NSString *)coreMessage {
+- (void)span:(NSString *)name block:(void (^)(void))block {
+
+  uint64_t start = [Clock uptime];
+  block();
+  [self endSpan:name start:start];
+}
+
+- (void)flushSpans {
+
+  for ( NSString *message in [self spanMessages] ) {
+
+    [self sendMessage:message];
+  }
+}
+
+- (void)flushWithDeadline:(NSTimeInterval)deadline completion:(void (^)(NSUInteger sent, NSUInteger persisted))completion {
+
+  /* span summaries go behind the queued events, so draining in queue order sends events first */
+  for ( NSString *message in [self spanMessages] ) {
+
+    [self addOutstandingMessage:message];
+  }
+
+  dispatch_queue_t flushQueue = dispatch_queue_create("com.vxstats.statistics.flush", DISPATCH_QUEUE_SERIAL);
+  __block NSUInteger remaining = [self outstandingMessageCount];
+  __block NSUInteger sent = 0;
+  __block NSUInteger inFlight = 0;
+  __block NSUInteger failures = 0;
+  NSMutableArray<NSURLSessionTask *> *tasks = [[NSMutableArray alloc] init];
+  __block BOOL stopped = NO;
+  __block BOOL expired = NO;
+  __block BOOL finished = NO;
+  __block void (^next)(void) = nil;
+
+  void (^finish)(void) = ^{
+
+    if ( finished || inFlight > 0 ) {
+
+      return;
+    }
+    finished = YES;
+    next = nil;
+    NSUInteger persisted = [self outstandingMessageCount];
+    if ( completion != nil ) {
+
+      dispatch_async(dispatch_get_main_queue(), ^{
+
+        completion(sent, persisted);
+      });
+    }
+  };
+
+  next = ^{
+
+    while ( !stopped && remaining > 0 && inFlight < FLUSH_CONCURRENCY ) {
+
+      remaining--;
+      NSString *message = [[self takeOutstandingMessages:1] firstObject];
+      if ( message == nil ) {
+
+        remaining = 0;
+        break;
+      }
+      if ( [message length] == 0 ) {
+
+        continue;
+      }
+      inFlight++;
+      [self sendMessage:message started:^(NSURLSessionTask *task) {
+
+        dispatch_async(flushQueue, ^{
+
+          /* retries on other servers start later, the deadline may already have passed */
+          if ( expired ) {
+
+            [task cancel];
+          }
+          else {
+
+            [tasks addObject:task];
+          }
+        });
+      } completion:^(BOOL success) {
+
+        dispatch_async(flushQueue, ^{
+
+          inFlight--;
+          if ( success ) {
+
+            sent++;
+            failures = 0;
+          }
+          else {
+
+            /* single errors are retried by the queue, a dead network or no server left ends the flush */
+            failures++;
+            BOOL available = NO;
+            for ( Endpoint *endpoint in [self endpoints] ) {
+
+              available = available || [endpoint isAvailable:[Clock now]];
+            }
+            stopped = stopped || failures >= FLUSH_FAILURE_LIMIT || !available;
+          }
+          if ( next != nil ) {
+
+            next();
+          }
+          else {
+
+            finish();
+          }
+        });
+      }];
+    }
+    if ( stopped || remaining == 0 ) {
+
+      finish();
+    }
+  };
+  dispatch_async(flushQueue, next);
+
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, ( int64_t )( deadline * NSEC_PER_SEC )), flushQueue, ^{
+
+    if ( finished ) {
+
+      return;
+    }
+    stopped = YES;
+    expired = YES;
+
+    /* cancelled requests fail and write their message back to the queue, requests not started by the flush keep running */
+    for ( NSURLSessionTask *task in tasks ) {
+
+      [task cancel];
+    }
+    finish();
+  });
+}
+
+- (NSArray<NSString *> *)spanMessages {
+
+  NSArray<NSString *> *summaries = [m_trace summaries];
+  if ( [summaries count] == 0 || [[[self configuration] disabledActions] containsObject:@"span"] ) {
+
+    return @[];
+  }
+  /* a summary covers spans of many pages, the current one would be misleading */
+  NSString *core = [self coreMessageForPage:@""];
+  NSMutableArray<NSString *> *messages = [NSMutableArray arrayWithCapacity:[summaries count]];
+  for ( NSString *summary in summaries ) {
+
+    NSMutableString *message = [[NSMutableString alloc] initWithString:core];
+    [message appendString:@"&action=span"];
+    [message appendString:summary];
+    [messages addObject:message];
+  }
+  return messages;
+}
+
+- (NSString *)coreMessage { return [self coreMessageForPage:lastPageName]; }
+
+- (NSString *)coreMessageForPage:(NSString *)pageName {
 
   NSMutableString *core = [[NSMutableString alloc] init];
   /* device block */
@@ -341,25 +707,60 @@ static Statistics *m_statisticInstance;
 #endif
 
   /* time block */
-  [core appendString:[NSString stringWithFormat:@"created=%.0f&", [[NSDate date] timeIntervalSince1970]]];
+  [core appendString:[NSString stringWithFormat:@"created=%.0f&", [Clock now]]];
 
   /* data block */
-  [core appendString:[NSString stringWithFormat:@"page=%@", lastPageName]];
+  [core appendString:[NSString stringWithFormat:@"page=%@", pageName]];
   return core;
 }
 
-- (void)sendMessage:(NSString *)message {
+- (void)sendMessage:(NSString *)message { [self sendMessage:message started:nil completion:nil]; }
+
+- (void)sendMessage:(NSString *)message started:(void (^)(NSURLSessionTask *task))started completion:(void (^)(BOOL sent))completion {
 
   if ( [message length] == 0 ) {
 
-    NSLog(@"%s %i: Bad implementation - 'message' is empty", __PRETTY_FUNCTION__, __LINE__);
+    /* nothing went out, a flush must not count it as sent */
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'message' is empty");
+    if ( completion != nil ) {
+
+      completion(NO);
+    }
     return;
   }
 
-  if ( [m_serverFilePath length] == 0 ) {
+  /* rare spans would otherwise wait for the next span or an explicit flush */
+  if ( [m_trace isDue] ) {
 
-    NSLog(@"%s %i: Bad implementation - 'serverFilePath' is empty - using: 'https://sandbox.vxstats.com'", __PRETTY_FUNCTION__, __LINE__);
-    m_serverFilePath = @"https://sandbox.vxstats.com";
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+
+      [self flushSpans];
+    });
+  }
+
+  void (^observer)(NSString *message, BOOL sent) = m_deliveryObserver;
+  if ( observer != nil ) {
+
+    void (^caller)(BOOL sent) = completion;
+    completion = ^(BOOL sent) {
+
+      observer(message, sent);
+      if ( caller != nil ) {
+
+        caller(sent);
+      }
+    };
+  }
+  [self sendMessage:message tried:@[] started:started completion:completion];
+}
+
+- (void)sendMessage:(NSString *)message tried:(NSArray<Endpoint *> *)tried started:(void (^)(NSURLSessionTask *task))started completion:(void (^)(BOOL sent))completion {
+
+  Configuration *configuration = [self configuration];
+  if ( [m_serverFilePath length] == 0 && [configuration serverFilePaths] == nil ) {
+
+    DIAGNOSTICS(DiagnosticsLevelWarning, @"Bad implementation - 'serverFilePath' is empty - using: 'https://sandbox.vxstats.com'");
+    [self serverFilePath:@"https://sandbox.vxstats.com"];
   }
 
   BOOL tracking = YES;
@@ -368,59 +769,203 @@ static Statistics *m_statisticInstance;
     tracking = [[NSUserDefaults standardUserDefaults] boolForKey:@"tracking"];
   }
 
-  NSURL *url = [NSURL URLWithString:m_serverFilePath];
-  if ( tracking && url ) {
+  Endpoint *endpoint = [self nextEndpoint];
+  NSString *authorization = [self authorization];
+  if ( [tried containsObject:endpoint] ) {
+
+    /* no other server left for a retry, the message waits in the queue */
+    [self addOutstandingMessage:message];
+    if ( completion != nil ) {
 
-    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+      completion(NO);
+    }
+  }
+  else if ( tracking && endpoint && authorization == nil ) {
+
+    /* the server would only answer with a challenge, keep the message for later */
+    DIAGNOSTICS(DiagnosticsLevelError, @"Authentication not possible, username or password empty.");
+    [self addOutstandingMessage:message];
+    if ( completion != nil ) {
+
+      completion(NO);
+    }
+  }
+  else if ( tracking && endpoint ) {
+
+    /* opted out users cause no traffic at all, not even for the configuration */
+    [self updateConfiguration];
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[endpoint url]];
     [request setHTTPMethod:@"POST"];
+    [self authorize:request];
     [request setValue:@"application/x-www-form-urlencoded" forHTTPHeaderField:@"content-type"];
-    [request setHTTPBody:[message dataUsingEncoding:NSUTF8StringEncoding]];
+    NSData *body = [message dataUsingEncoding:NSUTF8StringEncoding];
+    if ( [configuration compression] ) {
 
-    NSURLSessionConfiguration *defaultSessionConfiguration = [NSURLSessionConfiguration defaultSessionConfiguration];
-    NSURLSession *defaultSession = [NSURLSession sessionWithConfiguration:defaultSessionConfiguration delegate:self delegateQueue:nil];
-    NSURLSessionDataTask *session = [defaultSession dataTaskWithRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+      uLongf length = compressBound(( uLong )[body length]);
+      NSMutableData *compressed = [[NSMutableData alloc] initWithLength:length];
+      if ( compress2([compressed mutableBytes], &length, [body bytes], ( uLong )[body length], Z_DEFAULT_COMPRESSION) == Z_OK ) {
+
+        [compressed setLength:length];
+        body = compressed;
+        [request setValue:@"deflate" forHTTPHeaderField:@"content-encoding"];
+      }
+    }
+    [request setHTTPBody:body];
+
+    uint64_t start = [Clock uptime];
+    [endpoint willSend:[Clock now]];
+    NSURLSessionTask *task = [self sendRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
 
 #pragma unused(data)
-      if ( response == nil || error != nil ) {
+      if ( [[error domain] isEqualToString:NSURLErrorDomain] && [error code] == NSURLErrorCancelled ) {
 
-#ifdef DEBUG
-        NSLog(@"%s %i: Request failed with error: '%@'", __PRETTY_FUNCTION__, __LINE__, error);
-#endif
+        /* cancelled by a flush, neither the server's fault nor worth a retry */
         [self addOutstandingMessage:message];
+        if ( completion != nil ) {
+
+          completion(NO);
+        }
+        return;
+      }
+
+      /* server errors count against the endpoint */
+      NSInteger status = [response isKindOfClass:[NSHTTPURLResponse class]] ? [( NSHTTPURLResponse * )response statusCode] : 0;
+      BOOL success = response != nil && error == nil && status < 500;
+      [endpoint didFinish:success latency:( [Clock uptime] - start ) / ( double )NSEC_PER_SEC now:[Clock now]];
+      if ( !success ) {
+
+        /* failover: the next best server gets the message right away, every server once */
+        DIAGNOSTICS(DiagnosticsLevelInfo, @"Request to '%@' failed with status %li, error: '%@'", [endpoint url], ( long )status, error);
+        [self sendMessage:message tried:[tried arrayByAddingObject:endpoint] started:started completion:completion];
+        return;
+      }
+      if ( completion != nil ) {
+
+        completion(success);
       }
     }];
-    [session resume];
+    if ( task != nil && started != nil ) {
+
+      started(task);
+    }
   }
   else {
 
     [self addOutstandingMessage:message];
+    if ( completion != nil ) {
+
+      completion(NO);
+    }
   }
 }
 
 - (void)addOutstandingMessage:(NSString *)message {
 
+  /* shared with app extensions, appending never rewrites older messages */
+  if ( [m_queue push:message] ) {
+
+    return;
+  }
+
+  @synchronized ( self ) {
+
+    NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"group.com.vxstats.statistics"];
+    /* add to queue */
+    NSArray *existingMessages = [userDefaults objectForKey:@"offline"];
+    NSMutableArray *messages = [[NSMutableArray alloc] init];
+    if ( existingMessages != nil ) {
+
+      [messages addObjectsFromArray:existingMessages];
+    }
+    [messages addObject:message];
+    [userDefaults setObject:messages forKey:@"offline"];
+    [userDefaults synchronize];
+  }
+}
+
+- (NSUInteger)outstandingMessageCount {
+
   NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"group.com.vxstats.statistics"];
-  /* add to queue */
-  NSArray *existingMessages = [userDefaults objectForKey:@"offline"];
-  NSMutableArray *messages = [NSMutableArray alloc];
-  if ( existingMessages != nil ) {
+  NSArray *fallback = [userDefaults objectForKey:@"offline"];
+  return [m_queue count] + ( [fallback isKindOfClass:[NSArray class]] ? [fallback count] : 0 );
+}
+
+- (NSArray<NSString *> *)takeOutstandingMessages:(NSUInteger)limit {
+
+  NSMutableArray<NSString *> *messages = [[NSMutableArray alloc] initWithCapacity:MIN(limit, ( NSUInteger )1024)];
+  while ( [messages count] < limit ) {
+
+    NSString *message = [m_queue pop];
+    if ( message == nil ) {
+
+      break;
+    }
+    [messages addObject:message];
+  }
+  if ( [messages count] >= limit ) {
+
+    return messages;
+  }
+
+  /* messages the ring did not take, e.g. while the file could not be opened */
+  @synchronized ( self ) {
+
+    NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"group.com.vxstats.statistics"];
+    NSArray *fallback = [userDefaults objectForKey:@"offline"];
+    if ( ![fallback isKindOfClass:[NSArray class]] || [fallback count] == 0 ) {
+
+      return messages;
+    }
+    NSUInteger take = MIN([fallback count], limit - [messages count]);
+    for ( NSUInteger x = 0; x < take; ++x ) {
+
+      if ( [fallback[x] isKindOfClass:[NSString class]] ) {
+
+        [messages addObject:fallback[x]];
+      }
+    }
+
+    /* written back before sending, so messages failing again are queued behind the rest */
+    NSArray *remaining = [fallback subarrayWithRange:NSMakeRange(take, [fallback count] - take)];
+    if ( [remaining count] > 0 ) {
+
+      [userDefaults setObject:remaining forKey:@"offline"];
+    }
+    else {
 
-    [messages addObjectsFromArray:existingMessages];
+      [userDefaults removeObjectForKey:@"offline"];
+    }
+    [userDefaults synchronize];
   }
-  [messages addObject:message];
-  [userDefaults setObject:messages forKey:@"offline"];
-  [userDefaults synchronize];
+  return messages;
 }
 
 - (void)sendOutstandingMessages {
 
-  NSUserDefaults *userDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"group.com.vxstats.statistics"];
-  NSArray *messages = [userDefaults objectForKey:@"offline"];
-  [userDefaults removeObjectForKey:@"offline"];
-  [userDefaults synchronize];
-  for ( NSUInteger x = 0; x < [messages count]; ++x ) {
+  /* extensions only append, the app drains the queue */
+  if ( [OfflineQueue isExtension] ) {
+
+    return;
+  }
 
-    [self sendMessage:[messages objectAtIndex:x]];
+  /* without credentials every message would be queued again, updateAuthorization drains later */
+  if ( [self authorization] == nil ) {
+
+    return;
+  }
+
+  /* messages failing again are appended behind, so stop after the current ones */
+  NSUInteger count = [self outstandingMessageCount];
+  NSUInteger batchSize = [[self configuration] batchSize];
+  if ( batchSize > 0 && count > batchSize ) {
+
+    /* the remaining messages are sent on the next reconnect */
+    count = batchSize;
+  }
+  for ( NSString *message in [self takeOutstandingMessages:count] ) {
+
+    [self sendMessage:message];
   }
 }
 
@@ -428,20 +973,335 @@ static Statistics *m_statisticInstance;
 
   if ( reachability == m_reachability ) {
 
-    if ( [reachability currentReachabilityStatus] == ReachableViaWiFi ) {
+    [self networkStatus:[reachability currentReachabilityStatus]];
+  }
+}
+
+- (void)deliveryObserver:(void (^)(NSString *message, BOOL sent))observer { m_deliveryObserver = [observer copy]; }
+
+- (void)networkStatus:(NetworkStatus)status {
+
+  if ( status == ReachableViaWiFi ) {
+
+    [self sendOutstandingMessages];
+    m_status = @"Wifi";
+  }
+  else if ( status == ReachableViaWWAN ) {
+
+    [self sendOutstandingMessages];
+    m_status = @"WWAN";
+  }
+  else {
+
+    m_status = @"Offline";
+  }
+}
+
+#pragma mark - Configuration
+
+- (Configuration *)configuration {
+
+  const void *configuration = atomic_load_explicit(&m_configuration, memory_order_acquire);
+  return configuration != NULL ? ( __bridge Configuration * )configuration : [Configuration defaultConfiguration];
+}
+
+- (void)applyConfiguration:(Configuration *)configuration {
+
+  [m_trace setFlushCount:[configuration flushCount]];
+  [m_trace setFlushInterval:[configuration flushInterval]];
+
+  /*
+   * Readers on the event path load the bare pointer and retain it right
+   * after, so a replaced snapshot is released only after a grace period that
+   * no reader can still be in between load and retain.
+   */
+  const void *previous = atomic_exchange_explicit(&m_configuration, ( __bridge_retained const void * )configuration, memory_order_acq_rel);
+  if ( previous != NULL ) {
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, ( int64_t )( 60 * NSEC_PER_SEC )), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+
+      CFRelease(previous);
+    });
+  }
+  [self updateEndpoints];
+}
+
+- (NSURL *)configurationURL {
+
+  if ( [m_configurationFilePath length] > 0 ) {
+
+    return [NSURL URLWithString:m_configurationFilePath];
+  }
+  NSString *serverFilePath = [[self configuration] serverFilePaths] != nil ? [[[self configuration] serverFilePaths] firstObject] : m_serverFilePath;
+  if ( [serverFilePath length] == 0 ) {
+
+    return nil;
+  }
+  return [[NSURL URLWithString:@"configuration.json" relativeToURL:[NSURL URLWithString:serverFilePath]] absoluteURL];
+}
+
+- (NSString *)configurationCachePath {
+
+  if ( m_configurationCachePath != nil ) {
+
+    return m_configurationCachePath;
+  }
+
+  /* the local settings name the document, a server override must not pick its own cache */
+  NSString *source = [m_configurationFilePath length] > 0 ? m_configurationFilePath : m_serverFilePath;
+  if ( [source length] == 0 ) {
+
+    return nil;
+  }
+
+  /* caches of non-sandboxed macOS apps are shared, so every app and server gets its own file (FNV-1a) */
+  NSString *bundle = [[NSBundle mainBundle] bundleIdentifier] ?: [[NSProcessInfo processInfo] processName];
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for ( const char *sign = [source UTF8String]; *sign != '\0'; ++sign ) {
+
+    hash = ( hash ^ ( uint8_t )*sign ) * 0x100000001b3ULL;
+  }
+  NSString *caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+  return [caches stringByAppendingPathComponent:[NSString stringWithFormat:@"com.vxstats.statistics.configuration.%@.%016llx.plist", bundle, ( unsigned long long )hash]];
+}
+
+- (void)loadCachedConfiguration {
+
+  NSString *path = [self configurationCachePath];
+  NSDictionary *cache = path != nil ? [NSDictionary dictionaryWithContentsOfFile:path] : nil;
+  NSData *data = [cache objectForKey:@"data"];
+  id document = [data isKindOfClass:[NSData class]] ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+  if ( ![document isKindOfClass:[NSDictionary class]] ) {
+
+    /* nothing cached for this document, fetch it with the next message */
+    [self applyConfiguration:[Configuration defaultConfiguration]];
+    @synchronized ( self ) {
+
+      m_configurationETag = nil;
+      m_configurationValidated = 0;
+    }
+    return;
+  }
+  [self applyConfiguration:[[Configuration alloc] initWithDictionary:document]];
+  @synchronized ( self ) {
+
+    m_configurationETag = [cache objectForKey:@"etag"];
+    m_configurationValidated = [[cache objectForKey:@"validated"] doubleValue];
+  }
+}
+
+- (void)updateConfiguration {
+
+  /* unlocked fast path, called for every message */
+  NSTimeInterval now = [Clock now];
+  if ( now - m_configurationValidated < [[self configuration] maxAge] ) {
+
+    return;
+  }
+
+  @synchronized ( self ) {
 
-      [self sendOutstandingMessages];
-      m_status = @"Wifi";
+    if ( m_configurationLoading || now - m_configurationValidated < [[self configuration] maxAge] ) {
+
+      return;
     }
-    else if ( [reachability currentReachabilityStatus] == ReachableViaWWAN ) {
+    m_configurationLoading = YES;
+  }
 
-      [self sendOutstandingMessages];
-      m_status = @"WWAN";
+  NSURL *url = [self configurationURL];
+  if ( url == nil ) {
+
+    @synchronized ( self ) {
+
+      m_configurationLoading = NO;
     }
-    else {
+    return;
+  }
+
+  NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url cachePolicy:NSURLRequestReloadIgnoringLocalCacheData timeoutInterval:30.0];
+  [self authorize:request];
+  NSString *etag = m_configurationETag;
+  if ( [etag length] > 0 ) {
+
+    [request setValue:etag forHTTPHeaderField:@"if-none-match"];
+  }
+
+  [self sendRequest:request completionHandler:^(NSData *data, NSURLResponse *response, NSError *error) {
+
+    NSInteger status = [response isKindOfClass:[NSHTTPURLResponse class]] ? [( NSHTTPURLResponse * )response statusCode] : 0;
+    NSTimeInterval now = [Clock now];
+    NSString *cacheETag = nil;
+    NSData *cacheData = nil;
+    if ( error == nil && status == 200 && [data length] > 0 ) {
+
+      id document = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+      if ( [document isKindOfClass:[NSDictionary class]] ) {
+
+        [self applyConfiguration:[[Configuration alloc] initWithDictionary:document]];
+        NSDictionary *headers = [( NSHTTPURLResponse * )response allHeaderFields];
+        cacheETag = [headers objectForKey:@"Etag"] ?: [headers objectForKey:@"ETag"];
+        cacheData = data;
+      }
+    }
+    else if ( error == nil && status == 304 ) {
+
+      /* unchanged, only the validation time moves */
+      NSDictionary *cache = [NSDictionary dictionaryWithContentsOfFile:[self configurationCachePath]];
+      cacheETag = [cache objectForKey:@"etag"];
+      cacheData = [cache objectForKey:@"data"];
+    }
+
+    @synchronized ( self ) {
 
-      m_status = @"Offline";
+      NSString *path = [self configurationCachePath];
+      if ( cacheData != nil && path != nil ) {
+
+        m_configurationETag = cacheETag;
+        NSMutableDictionary *cache = [[NSMutableDictionary alloc] init];
+        [cache setObject:cacheData forKey:@"data"];
+        [cache setObject:@(now) forKey:@"validated"];
+        if ( cacheETag != nil ) {
+
+          [cache setObject:cacheETag forKey:@"etag"];
+        }
+        [cache writeToFile:path atomically:YES];
+      }
+
+      /* failed requests are retried after the same interval, not on every event */
+      m_configurationValidated = now;
+      m_configurationLoading = NO;
     }
+  }];
+}
+
+#pragma mark - Endpoints
+
+- (void)updateEndpoints {
+
+  /* server provided paths win over local ones */
+  NSArray<NSString *> *paths = [[self configuration] serverFilePaths];
+  if ( paths == nil ) {
+
+    paths = m_serverFilePaths;
+  }
+
+  @synchronized ( self ) {
+
+    /* keep the health of servers that stay in the list */
+    NSMutableDictionary *existing = [[NSMutableDictionary alloc] init];
+    for ( Endpoint *endpoint in m_endpoints ) {
+
+      [existing setObject:endpoint forKey:[[endpoint url] absoluteString]];
+    }
+
+    NSMutableArray<Endpoint *> *endpoints = [[NSMutableArray alloc] initWithCapacity:[paths count]];
+    for ( NSString *path in paths ) {
+
+      NSURL *url = [NSURL URLWithString:path];
+      if ( url == nil ) {
+
+        continue;
+      }
+      Endpoint *endpoint = [existing objectForKey:[url absoluteString]];
+      [endpoints addObject:( endpoint != nil ? endpoint : [[Endpoint alloc] initWithURL:url] )];
+    }
+    m_endpoints = endpoints;
+  }
+}
+
+- (NSArray<Endpoint *> *)endpoints {
+
+  /* replaced from the session delegate queue, an unlocked load could retain a released array */
+  @synchronized ( self ) {
+
+    return m_endpoints;
+  }
+}
+
+- (Endpoint *)nextEndpoint {
+
+  NSArray<Endpoint *> *endpoints = [self endpoints];
+  NSTimeInterval now = [Clock now];
+  Endpoint *best = nil;
+  double bestScore = DBL_MAX;
+  for ( Endpoint *endpoint in endpoints ) {
+
+    /* a single request re-probes a failed server once its delay passed */
+    if ( [endpoint isProbeDue:now] ) {
+
+      return endpoint;
+    }
+    if ( [endpoint isAvailable:now] && [endpoint score] < bestScore ) {
+
+      best = endpoint;
+      bestScore = [endpoint score];
+    }
+  }
+  if ( best == nil ) {
+
+    /* all servers failed, the first one keeps receiving the traffic */
+    best = [endpoints firstObject];
+  }
+  return best;
+}
+
+#pragma mark - Transport
+
+- (NSURLSessionTask *)sendRequest:(NSURLRequest *)request completionHandler:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionHandler {
+
+  if ( m_transport != nil ) {
+
+    [m_transport sendRequest:request completionHandler:completionHandler];
+    return nil;
+  }
+
+  NSURLSessionDataTask *task = [m_session dataTaskWithRequest:request completionHandler:completionHandler];
+  [task resume];
+  return task;
+}
+
+#pragma mark - Authorization
+
+- (void)updateAuthorization {
+
+  /* read on session delegate threads and the flush queue, so replaced under the lock like the endpoints */
+  BOOL missing = NO;
+  @synchronized ( self ) {
+
+    if ( [m_username length] == 0 || [m_password length] == 0 ) {
+
+      m_authorization = nil;
+      return;
+    }
+
+    /* basic authorization, encoded once instead of per request */
+    NSData *credentials = [[NSString stringWithFormat:@"%@:%@", m_username, m_password] dataUsingEncoding:NSUTF8StringEncoding];
+    missing = m_authorization == nil;
+    m_authorization = [@"Basic " stringByAppendingString:[credentials base64EncodedStringWithOptions:0]];
+  }
+
+  /* messages kept while the credentials were missing can go out now */
+  if ( missing && ![m_status isEqualToString:@"Offline"] ) {
+
+    [self sendOutstandingMessages];
+  }
+}
+
+- (NSString *)authorization {
+
+  @synchronized ( self ) {
+
+    return m_authorization;
+  }
+}
+
+- (void)authorize:(NSMutableURLRequest *)request {
+
+  /* preemptive credentials only over TLS, plain HTTP servers have to ask with a challenge */
+  NSString *authorization = [self authorization];
+  if ( authorization != nil && [[[request URL] scheme] caseInsensitiveCompare:@"https"] == NSOrderedSame ) {
+
+    [request setValue:authorization forHTTPHeaderField:@"authorization"];
   }
 }
 
@@ -465,13 +1325,22 @@ static Statistics *m_statisticInstance;
   }
   else {
 
-    if ( m_username == nil || m_password == nil ) {
+    NSString *username = nil;
+    NSString *password = nil;
+    @synchronized ( self ) {
+
+      username = m_username;
+      password = m_password;
+    }
+
+    /* a second challenge means the credentials were rejected, asking again would loop */
+    if ( [username length] == 0 || [password length] == 0 || [challenge previousFailureCount] > 0 ) {
 
-      NSLog(@"%s %i: Authentication not possible, username or password empty.", __PRETTY_FUNCTION__, __LINE__);
+      DIAGNOSTICS(DiagnosticsLevelError, @"Authentication not possible, username or password empty or rejected.");
+      completionHandler(NSURLSessionAuthChallengeCancelAuthenticationChallenge, nil);
       return;
     }
-    NSURLCredential *credential = [NSURLCredential credentialWithUser:m_username password:m_password persistence:NSURLCredentialPersistencePermanent];
-    [[challenge sender] useCredential:credential forAuthenticationChallenge:challenge];
+    NSURLCredential *credential = [NSURLCredential credentialWithUser:username password:password persistence:NSURLCredentialPersistenceForSession];
     completionHandler(NSURLSessionAuthChallengeUseCredential, credential);
   }
 }
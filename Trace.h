@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* sys header */
+#include <pthread.h>
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The Trace class.
+ * Aggregates span durations per name into log-linear latency histograms, so
+ * that only one summary record per name has to be transferred instead of one
+ * event per measurement. Every power of two in nanoseconds is split into eight
+ * linear buckets, which keeps the relative error below 12.5%.
+ *
+ * @~german
+ * @brief Die Klasse Trace.
+ * Fasst Span-Dauern pro Name in log-linearen Latenzhistogrammen zusammen,
+ * damit nur ein Zusammenfassungseintrag pro Name statt eines Events pro
+ * Messung übertragen werden muss. Jede Zweierpotenz in Nanosekunden wird in
+ * acht lineare Bereiche geteilt, der relative Fehler bleibt unter 12,5%.
+ */
+@interface Trace : NSObject {
+
+@private
+  /**
+   * @~english
+   * @brief Histogram data by span name.
+   *
+   * @~german
+   * @brief Histogrammdaten nach Span-Name.
+   */
+  NSMutableDictionary *m_histograms;
+
+  /**
+   * @~english
+   * @brief Protects the histograms, cheaper than \@synchronized on this path.
+   *
+   * @~german
+   * @brief Schützt die Histogramme, günstiger als \@synchronized auf diesem Pfad.
+   */
+  pthread_mutex_t m_mutex;
+
+  /**
+   * @~english
+   * @brief Set once a flush was requested, until the summaries are taken.
+   *
+   * @~german
+   * @brief Gesetzt, sobald eine Übertragung angefordert wurde, bis die
+   * Zusammenfassungen abgeholt sind.
+   */
+  BOOL m_flushPending;
+
+  /**
+   * @~english
+   * @brief Uptime of the oldest sample not yet summarized, 0 if there is none.
+   *
+   * @~german
+   * @brief Uptime der ältesten noch nicht zusammengefassten Messung, 0 wenn es
+   * keine gibt.
+   */
+  uint64_t m_started;
+}
+
+/**
+ * @~english
+ * @brief Maximum number of samples per name before a summary is due.
+ *
+ * @~german
+ * @brief Maximale Anzahl an Messungen pro Name, bevor eine Zusammenfassung
+ * fällig ist.
+ */
+@property (nonatomic, assign) uint32_t flushCount;
+
+/**
+ * @~english
+ * @brief Maximum age in seconds of a histogram before a summary is due.
+ *
+ * @~german
+ * @brief Maximales Alter eines Histogramms in Sekunden, bevor eine
+ * Zusammenfassung fällig ist.
+ */
+@property (nonatomic, assign) NSTimeInterval flushInterval;
+
+/**
+ * @~english
+ * @brief Adds a measured duration to the histogram of name.
+ * @param nanoseconds   The duration.
+ * @param name   The escaped span name.
+ * @return True, if summaries should be flushed - otherwise false. Only the
+ * first call after Trace#summaries returns true.
+ *
+ * @~german
+ * @brief Fügt eine gemessene Dauer dem Histogramm von name hinzu.
+ * @param nanoseconds   Die Dauer.
+ * @param name   Der maskierte Span-Name.
+ * @return Wahr, wenn die Zusammenfassungen übertragen werden sollen - sonst
+ * falsch. Nur der erste Aufruf nach Trace#summaries gibt wahr zurück.
+ */
+- (BOOL)record:(uint64_t)nanoseconds forName:(NSString *)name;
+
+/**
+ * @~english
+ * @brief Checks the age limit without a new sample, so that rare spans are not
+ * held back until the next one is recorded.
+ * @return True, if the oldest sample is older than Trace#flushInterval and no
+ * flush was requested yet - otherwise false.
+ *
+ * @~german
+ * @brief Prüft das Alterslimit ohne neue Messung, damit seltene Spans nicht bis
+ * zur nächsten Messung zurückgehalten werden.
+ * @return Wahr, wenn die älteste Messung älter als Trace#flushInterval ist und
+ * noch keine Übertragung angefordert wurde - sonst falsch.
+ */
+- (BOOL)isDue;
+
+/**
+ * @~english
+ * @brief Returns one encoded summary per span name and resets all histograms.
+ * @return Message fragments starting with '&value=<name>'.
+ *
+ * @~german
+ * @brief Gibt eine kodierte Zusammenfassung pro Span-Name zurück und setzt
+ * alle Histogramme zurück.
+ * @return Nachrichtenteile beginnend mit '&value=<name>'.
+ */
+- (NSArray<NSString *> *)summaries;
+
+@end
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* local header */
+#import "Clock.h"
+#import "Trace.h"
+#include "TraceHistogram.h"
+
+@implementation Trace
+
+@synthesize flushCount;
+@synthesize flushInterval;
+
+- (id)init {
+
+  if ( ( self = [super init] ) ) {
+
+    m_histograms = [[NSMutableDictionary alloc] init];
+    pthread_mutex_init(&m_mutex, NULL);
+    m_flushPending = NO;
+    m_started = 0;
+    flushCount = 1024;
+    flushInterval = 300.0;
+  }
+  return self;
+}
+
+- (void)dealloc { pthread_mutex_destroy(&m_mutex); }
+
+- (BOOL)record:(uint64_t)nanoseconds forName:(NSString *)name {
+
+  if ( [name length] == 0 ) {
+
+    return NO;
+  }
+
+  uint64_t now = [Clock uptime];
+  pthread_mutex_lock(&m_mutex);
+  NSMutableData *data = [m_histograms objectForKey:name];
+  if ( data == nil ) {
+
+    data = [[NSMutableData alloc] initWithLength:sizeof(TraceHistogram)];
+    [m_histograms setObject:data forKey:name];
+  }
+  TraceHistogram *histogram = [data mutableBytes];
+  if ( histogram->count == 0 ) {
+
+    histogram->started = now;
+  }
+  if ( m_started == 0 ) {
+
+    m_started = now;
+  }
+  trace_histogram_add(histogram, nanoseconds);
+  BOOL due = histogram->count >= flushCount || ( now - m_started ) > ( uint64_t )( flushInterval * NSEC_PER_SEC );
+
+  /* one flush per swap, otherwise every following span would request another one */
+  due = due && !m_flushPending;
+  if ( due ) {
+
+    m_flushPending = YES;
+  }
+  pthread_mutex_unlock(&m_mutex);
+  return due;
+}
+
+- (BOOL)isDue {
+
+  uint64_t now = [Clock uptime];
+  pthread_mutex_lock(&m_mutex);
+  BOOL due = !m_flushPending && m_started != 0 && ( now - m_started ) > ( uint64_t )( flushInterval * NSEC_PER_SEC );
+  if ( due ) {
+
+    m_flushPending = YES;
+  }
+  pthread_mutex_unlock(&m_mutex);
+  return due;
+}
+
+- (NSArray<NSString *> *)summaries {
+
+  pthread_mutex_lock(&m_mutex);
+  NSDictionary *histograms = m_histograms;
+  m_histograms = [[NSMutableDictionary alloc] init];
+  m_flushPending = NO;
+  m_started = 0;
+  pthread_mutex_unlock(&m_mutex);
+
+  NSMutableArray *summaries = [NSMutableArray arrayWithCapacity:[histograms count]];
+  [histograms enumerateKeysAndObjectsUsingBlock:^(NSString *name, NSData *data, BOOL *stop) {
+
+#pragma unused(stop)
+    const TraceHistogram *histogram = [data bytes];
+    if ( histogram->count == 0 ) {
+
+      return;
+    }
+
+    /* all durations in microseconds, buckets stay in their native index so the server can merge them */
+    NSMutableString *summary = [[NSMutableString alloc] init];
+    [summary appendFormat:@"&value=%@", name];
+    [summary appendFormat:@"&count=%u", histogram->count];
+    [summary appendFormat:@"&mean=%.1f", ( double )histogram->sum / histogram->count / 1000.0];
+    [summary appendFormat:@"&p50=%.1f", trace_histogram_percentile(histogram, 0.50) / 1000.0];
+    [summary appendFormat:@"&p90=%.1f", trace_histogram_percentile(histogram, 0.90) / 1000.0];
+    [summary appendFormat:@"&p99=%.1f", trace_histogram_percentile(histogram, 0.99) / 1000.0];
+    [summary appendFormat:@"&max=%.1f", histogram->max / 1000.0];
+    [summary appendString:@"&buckets="];
+    BOOL first = YES;
+    for ( NSUInteger x = 0; x < TRACE_BUCKETS; ++x ) {
+
+      if ( histogram->buckets[x] > 0 ) {
+
+        [summary appendFormat:first ? @"%lu:%u" : @",%lu:%u", ( unsigned long )x, histogram->buckets[x]];
+        first = NO;
+      }
+    }
+    [summaries addObject:summary];
+  }];
+  return summaries;
+}
+
+@end
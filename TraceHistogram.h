@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+#ifndef TRACEHISTOGRAM_H
+#define TRACEHISTOGRAM_H
+
+/* c header */
+#include <math.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 16 exact buckets below 16ns, then 8 linear buckets per power of two */
+#define TRACE_SUB_BUCKETS 8
+#define TRACE_BUCKETS ( 16 + ( 64 - 4 ) * TRACE_SUB_BUCKETS )
+
+/**
+ * @~english
+ * @brief Log-linear histogram of durations in nanoseconds, used by Trace and
+ * by the load test. The bucket index is part of the span summaries, so the
+ * layout must not change without a new summary format.
+ *
+ * @~german
+ * @brief Log-lineares Histogramm von Dauern in Nanosekunden, verwendet von
+ * Trace und vom Lasttest. Der Bucket-Index ist Teil der Span-Zusammenfassungen,
+ * das Layout darf sich daher nicht ohne neues Format ändern.
+ */
+typedef struct {
+
+  uint32_t count;
+  uint64_t sum;
+  uint64_t max;
+  uint64_t started;
+  uint32_t buckets[TRACE_BUCKETS];
+} TraceHistogram;
+
+/**
+ * @~english
+ * @brief Bucket of a value.
+ * @param value   The value.
+ * @return The bucket index below TRACE_BUCKETS.
+ *
+ * @~german
+ * @brief Bucket eines Werts.
+ * @param value   Der Wert.
+ * @return Der Bucket-Index unter TRACE_BUCKETS.
+ */
+static inline uint32_t trace_histogram_bucket(uint64_t value) {
+
+  if ( value < 16 ) {
+
+    return ( uint32_t )value;
+  }
+  uint32_t exponent = 63 - ( uint32_t )__builtin_clzll(value);
+  uint32_t sub = ( uint32_t )( value >> ( exponent - 3 ) ) & ( TRACE_SUB_BUCKETS - 1 );
+  return 16 + ( exponent - 4 ) * TRACE_SUB_BUCKETS + sub;
+}
+
+/**
+ * @~english
+ * @brief Smallest value of a bucket.
+ * @param bucket   The bucket index.
+ * @return The lower bound.
+ *
+ * @~german
+ * @brief Kleinster Wert eines Buckets.
+ * @param bucket   Der Bucket-Index.
+ * @return Die Untergrenze.
+ */
+static inline uint64_t trace_histogram_lower_bound(uint32_t bucket) {
+
+  if ( bucket < 16 ) {
+
+    return bucket;
+  }
+  uint32_t exponent = ( bucket - 16 ) / TRACE_SUB_BUCKETS + 4;
+  uint32_t sub = ( bucket - 16 ) % TRACE_SUB_BUCKETS;
+  return ( ( uint64_t )( TRACE_SUB_BUCKETS + sub ) ) << ( exponent - 3 );
+}
+
+/**
+ * @~english
+ * @brief Adds a value. The start time is left to the caller.
+ * @param histogram   The histogram.
+ * @param value   The duration in nanoseconds.
+ *
+ * @~german
+ * @brief Fügt einen Wert hinzu. Die Startzeit setzt der Aufrufer.
+ * @param histogram   Das Histogramm.
+ * @param value   Die Dauer in Nanosekunden.
+ */
+static inline void trace_histogram_add(TraceHistogram *histogram, uint64_t value) {
+
+  histogram->count++;
+  histogram->sum += value;
+  histogram->max = value > histogram->max ? value : histogram->max;
+  histogram->buckets[trace_histogram_bucket(value)]++;
+}
+
+/**
+ * @~english
+ * @brief Estimated percentile, the middle of the bucket but never above the
+ * measured maximum.
+ * @param histogram   The histogram.
+ * @param percentile   The percentile between 0 and 1.
+ * @return The value in nanoseconds.
+ *
+ * @~german
+ * @brief Geschätztes Perzentil, die Mitte des Buckets, aber nie über dem
+ * gemessenen Maximum.
+ * @param histogram   Das Histogramm.
+ * @param percentile   Das Perzentil zwischen 0 und 1.
+ * @return Der Wert in Nanosekunden.
+ */
+static inline uint64_t trace_histogram_percentile(const TraceHistogram *histogram, double percentile) {
+
+  uint64_t rank = ( uint64_t )ceil(histogram->count * percentile);
+  uint64_t seen = 0;
+  for ( uint32_t x = 0; x < TRACE_BUCKETS; ++x ) {
+
+    seen += histogram->buckets[x];
+    if ( seen >= rank && histogram->buckets[x] > 0 ) {
+
+      uint64_t lower = trace_histogram_lower_bound(x);
+      uint64_t upper = x + 1 < TRACE_BUCKETS ? trace_histogram_lower_bound(x + 1) : lower;
+      uint64_t middle = ( lower + upper ) / 2;
+      return middle < histogram->max ? middle : histogram->max;
+    }
+  }
+  return histogram->max;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACEHISTOGRAM_H */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 10/01/2020 VX STATS <sales@vxstats.com>
+ *
+ * This document is property of VX STATS. It is strictly prohibited
+ * to modify, sell or publish it in any way. In case you have access
+ * to this document, you are obligated to ensure its nondisclosure.
+ * Noncompliances will be prosecuted.
+ *
+ * Diese Datei ist Eigentum der VX STATS. Jegliche Änderung, Verkauf
+ * oder andere Verbreitung und Veröffentlichung ist strikt untersagt.
+ * Falls Sie Zugang zu dieser Datei haben, sind Sie verpflichtet,
+ * alles in Ihrer Macht stehende für deren Geheimhaltung zu tun.
+ * Zuwiderhandlungen werden strafrechtlich verfolgt.
+ */
+
+/* modules */
+@import Foundation;
+
+/**
+ * @~english
+ * @brief The Transport protocol.
+ * Replaces NSURLSession for all requests of the statistics system, e.g. with
+ * a simulated server.
+ *
+ * @~german
+ * @brief Das Protokoll Transport.
+ * Ersetzt NSURLSession für alle Anfragen des Statistiksystems, z.B. durch
+ * einen simulierten Server.
+ */
+@protocol Transport <NSObject>
+
+/**
+ * @~english
+ * @brief Sends a request and calls completionHandler exactly once, with the
+ * same arguments as NSURLSession data tasks.
+ * @param request   The request.
+ * @param completionHandler   Called with the response or the error.
+ *
+ * @~german
+ * @brief Sendet eine Anfrage und ruft completionHandler genau einmal auf, mit
+ * denselben Argumenten wie NSURLSession-Datentasks.
+ * @param request   Die Anfrage.
+ * @param completionHandler   Wird mit der Antwort oder dem Fehler aufgerufen.
+ */
+- (void)sendRequest:(NSURLRequest *)request completionHandler:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionHandler;
+
+@end